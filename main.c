@@ -1,7 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "tree.h"
+#include "tree_diff.h"
+#include "tree_analytics.h"
+#include "tree_async.h"
+#include "tree_server.h"
+#include "tree_traverse.h"
+#include "tree_io.h"
 
 /* 򵥴ӡصʾ */
 static void print_node(const TreeNode* node)
@@ -12,15 +19,257 @@ static void print_node(const TreeNode* node)
     }
 }
 
-int main(void)
+/* ӡһֱͼĻܣһΪϡ */
+static void print_histogram(const char* title, const TreeHistogram* h)
 {
+    printf("%s:  %zu, ƽ %.2f,  %zu, p50 %zu, p90 %zu, p99 %zu\n",
+        title, h->samples, h->mean, h->max, h->p50, h->p90, h->p99);
+    for (size_t i = 0; i < h->bin_count; ++i)
+    {
+        if (h->bins[i] == 0)
+        {
+            continue;
+        }
+        printf("  %zu%s: %zu\n", i, (i + 1 == h->bin_count) ? "+" : "", h->bins[i]);
+    }
+}
+
+/* ͷŵǰȡһڴ棬 tree_free_block */
+static void release_tree(TreeNode** root, int* is_block)
+{
+    if (*root)
+    {
+        if (*is_block)
+        {
+            tree_free_block(*root);
+        }
+        else
+        {
+            tree_free(*root);
+        }
+    }
+    *root = NULL;
+    *is_block = 0;
+}
+
+/* ȡ̨ؽɹ滻ǰ */
+static void finish_load(TreeLoadHandle** pending, TreeNode** root, int* is_block)
+{
+    TreeLoadStatus status;
+    TreeNode* loaded = tree_load_finish(*pending, &status);
+    *pending = NULL;
+
+    if (status == TREE_LOAD_DONE)
+    {
+        release_tree(root, is_block);
+        *root = loaded;
+        printf("سɹ\n");
+    }
+    else if (status == TREE_LOAD_CANCELLED)
+    {
+        printf("̨ȡǰֲ䡣\n");
+    }
+    else
+    {
+        printf("ʧܣļʽ·\n");
+    }
+}
+
+/* ---------------- ׼ָ汾 tree_traverse.h ɵ汾 ---------------- */
+
+typedef struct TraverseAcc
+{
+    size_t count;
+    size_t sum;
+} TraverseAcc;
+
+static TraverseAcc g_visit_acc;
+
+static void bench_visit(const TreeNode* node)
+{
+    g_visit_acc.count++;
+    g_visit_acc.sum += (unsigned char)node->data[0];
+}
+
+TREE_DEFINE_PREORDER(bench_preorder, TraverseAcc*, ctx->count++; ctx->sum += (unsigned char)node->data[0];)
+TREE_DEFINE_POSTORDER(bench_postorder, TraverseAcc*, ctx->count++; ctx->sum += (unsigned char)node->data[0];)
+TREE_DEFINE_LEVEL_ORDER(bench_level_order, TraverseAcc*, ctx->count++; ctx->sum += (unsigned char)node->data[0];)
+
+/* һڴй n ڵȫ 8 ˳ţ tree_free_block ͷ */
+static TreeNode* build_bench_tree(size_t n)
+{
+    static char labels[8][2] = { "a", "b", "c", "d", "e", "f", "g", "h" };
+    TreeNode* nodes = (TreeNode*)tree_mem_alloc(sizeof(TreeNode) * n);
+    if (!nodes)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t first = i * 8 + 1;
+        nodes[i].data = labels[i % 8];
+        nodes[i].first_child = (first < n) ? &nodes[first] : NULL;
+        nodes[i].next_sibling = (i > 0 && i % 8 != 0 && i + 1 < n) ? &nodes[i + 1] : NULL;
+    }
+    return nodes;
+}
+
+static double elapsed_ms(clock_t start)
+{
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+/* ÿ˳ 3 ȡһ */
+static int run_traverse_bench(size_t n)
+{
+    /* һʹڵ㰴ȸ˳ţ tree_create_from_stream ĲͬٻδжԱȽϵĸ */
+    TreeNode* bfs = build_bench_tree(n);
+    TreeNode* root = bfs ? tree_clone(bfs) : NULL;
+    if (bfs)
+    {
+        tree_free_block(bfs);
+    }
+    if (!root)
+    {
+        printf("ڴ治㣬޷ %zu ڵ\n", n);
+        return 1;
+    }
+
+    const char* names[3] = { "ȸ", "", "" };
+    int ok = 1;
+    printf("ڵ %zu\n", n);
+    for (int order = 0; order < 3; ++order)
+    {
+        double best_fn = 0.0;
+        double best_inline = 0.0;
+        TraverseAcc acc = { 0, 0 };
+        for (int rep = 0; rep < 3; ++rep)
+        {
+            g_visit_acc.count = 0;
+            g_visit_acc.sum = 0;
+            clock_t start = clock();
+            if (order == 0) { tree_preorder(root, bench_visit); }
+            else if (order == 1) { tree_postorder(root, bench_visit); }
+            else { tree_level_order(root, bench_visit); }
+            double t = elapsed_ms(start);
+            if (rep == 0 || t < best_fn) { best_fn = t; }
+
+            acc.count = 0;
+            acc.sum = 0;
+            start = clock();
+            int rc;
+            if (order == 0) { rc = bench_preorder(root, &acc); }
+            else if (order == 1) { rc = bench_postorder(root, &acc); }
+            else { rc = bench_level_order(root, &acc); }
+            t = elapsed_ms(start);
+            if (rep == 0 || t < best_inline) { best_inline = t; }
+
+            if (rc != 0 || acc.count != g_visit_acc.count || acc.sum != g_visit_acc.sum)
+            {
+                ok = 0;
+            }
+        }
+        printf("%s: ָ %.1f ms (%.2f ns/ڵ),  %.1f ms (%.2f ns/ڵ),  %.2fx\n",
+            names[order], best_fn, best_fn * 1e6 / (double)n, best_inline, best_inline * 1e6 / (double)n,
+            (best_inline > 0.0) ? best_fn / best_inline : 0.0);
+    }
+
+    tree_free_block(root);
+    if (!ok)
+    {
+        printf("ʵֵķʽһ£\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void print_usage(const char* prog)
+{
+    printf("÷:\n");
+    printf("  %s                                        ʽ˵\n", prog);
+    printf("  %s --serve <׽> <ļ> [߳]      һβṩزѯ\n", prog);
+    printf("  %s --bench <׽> [߳] [ÿ߳] [ˮ]  ѹѯ\n", prog);
+    printf("  %s --bench-traverse [ڵ]                  ȽϺָĬ 1000 ڵ㣩\n", prog);
+}
+
+/* ģʽѯѹͻˣ Linux׼ */
+static int run_command_line(int argc, char** argv)
+{
+    if (strcmp(argv[1], "--serve") == 0 && argc >= 4)
+    {
+        int workers = (argc >= 5) ? atoi(argv[4]) : 0;
+        TreeServer* server = tree_server_create(argv[2], argv[3], workers);
+        if (!server)
+        {
+            printf("ʧܣļ׽·ģʽ֧ Linux\n");
+            return 1;
+        }
+        printf(" %s ṩѯ񣬰 Ctrl+C ֹͣ\n", argv[2]);
+        int rc = tree_server_run(server);
+        tree_server_free(server);
+        printf("ֹͣ\n");
+        return (rc == 0) ? 0 : 1;
+    }
+
+    if (strcmp(argv[1], "--bench") == 0 && argc >= 3)
+    {
+        int threads = (argc >= 4) ? atoi(argv[3]) : 4;
+        long requests = (argc >= 5) ? atol(argv[4]) : 100000;
+        int pipeline = (argc >= 6) ? atoi(argv[5]) : 32;
+        if (requests <= 0)
+        {
+            printf("Ϊ\n");
+            return 1;
+        }
+        TreeBenchResult r;
+        if (tree_server_bench(argv[2], threads, (size_t)requests, pipeline, &r) != 0)
+        {
+            printf("ѹʧܣδжϣ\n");
+            return 1;
+        }
+        printf(" %llu  %lluʱ %.3f 룬QPS %.0f\n",
+            (unsigned long long)r.requests, (unsigned long long)r.errors, r.seconds, r.qps);
+        printf("ӳ: p50 %.1f us, p99 %.1f us,  %.1f us\n", r.p50_us, r.p99_us, r.max_us);
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--bench-traverse") == 0)
+    {
+        long n = (argc >= 3) ? atol(argv[2]) : 10000000L;
+        if (n <= 0)
+        {
+            printf("ڵΪ\n");
+            return 1;
+        }
+        return run_traverse_bench((size_t)n);
+    }
+
+    print_usage(argv[0]);
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1)
+    {
+        return run_command_line(argc, argv);
+    }
+
     TreeNode* root = NULL;
+    int root_is_block = 0; /* ǰǷ tree_create_from_stream  */
+    TreeLoadHandle* pending = NULL; /* ڽеĺ̨ */
     char choice_buf[16];
     char filename[256]; /* 뻺ļ */
     int choice = 0;
 
     for (;;)
     {
+        if (pending && tree_load_poll(pending) != TREE_LOAD_RUNNING)
+        {
+            finish_load(&pending, &root, &root_is_block);
+        }
+
         printf("\n======== ͽṹϢͳ ========\n");
         printf("0. ˳\n");
         printf("1. ӿ̨\n");
@@ -35,6 +284,16 @@ int main(void)
         printf("10. ȸ\n");
         printf("11. \n");
         printf("12. ͷŵǰ\n");
+        printf("13. ļ¼\n");
+        printf("14. ʾ / Ҷ / Сֲ\n");
+        printf("15. 鿴̨ؽ\n");
+        printf("16. ȡ̨\n");
+        printf("17. ʾڴռ\n");
+        printf("18. ļٶȡ\n");
+        printf("19. ʾҶ /  / ǰ 5 \n");
+        printf("20. ȡָڵΪǰ\n");
+        printf("21. Ӹڵ / ߱ļ\n");
+        printf("22. ǰʽ / DOT / JSON\n");
         printf("ѡ֣: ");
 
         if (!fgets(choice_buf, sizeof(choice_buf), stdin))
@@ -48,19 +307,15 @@ int main(void)
         switch (choice)
         {
         case 1:
-            if (root) /* ͷԭ */
-            {
-                tree_free(root);
-                root = NULL;
-            }
+            release_tree(&root, &root_is_block); /* ͷԭ */
             root = tree_create_from_console();
             break;
 
-        case 2:
-            if (root) /* ͷԭ */
+        case 2: /* ̨أɺ滻ǰ */
+            if (pending)
             {
-                tree_free(root);
-                root = NULL;
+                printf("к̨ڽУѡ 15 鿴ȣ16 ȡ\n");
+                break;
             }
             printf("ļ·: ");
             if (!fgets(filename, sizeof(filename), stdin)) /* ȡļ */
@@ -74,9 +329,9 @@ int main(void)
                 printf("Чļ\n");
                 continue;
             }
-            root = buildTreeFromFile(filename); /* ļ */
-            if (!root) { printf("ʧܣļʽ·\n"); }
-            else { printf("سɹ\n"); }
+            pending = tree_load_async(filename); /* ں̨ļ */
+            if (!pending) { printf("޷̨ء\n"); }
+            else { printf("ѿʼ̨أɼѡ 15 鿴ȣ16 ȡ\n"); }
             break;
 
         case 3:
@@ -133,8 +388,7 @@ int main(void)
         case 12: /* ͷŵǰԭ 10 */
             if (root)
             {
-                tree_free(root);
-                root = NULL;
+                release_tree(&root, &root_is_block);
                 printf("ͷŵǰ\n");
             }
             else
@@ -143,8 +397,234 @@ int main(void)
             }
             break;
 
+        case 13: /* ֻļеı仯Ӧõǰ */
+        {
+            if (root_is_block)
+            {
+                printf("ǰΪ洢ֻ֧¼ء\n");
+                break;
+            }
+            printf("ļ·: ");
+            if (!fgets(filename, sizeof(filename), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            filename[strcspn(filename, "\n")] = 0; /* ȥз */
+            if (strlen(filename) == 0)
+            {
+                printf("Чļ\n");
+                continue;
+            }
+            int replaced = 0;
+            int edits = tree_reload_from_file(&root, filename, &replaced);
+            if (edits < 0) { printf("¼ʧܣǰֲ䡣\n"); }
+            else if (replaced) { printf("޷£滻Ϊļе\n"); }
+            else { printf("¼ɣӦ %d ޸ġ\n", edits); }
+            break;
+        }
+
+        case 14: /* һαõֲַ */
+        {
+            if (!root) { printf("ȴһ\n"); break; }
+            size_t degree_bins[64];
+            size_t depth_bins[64];
+            size_t size_bins[64];
+            TreeDistribution dist;
+            dist.degree.bins = degree_bins;
+            dist.degree.bin_count = 64;
+            dist.leaf_depth.bins = depth_bins;
+            dist.leaf_depth.bin_count = 64;
+            dist.subtree_size.bins = size_bins;
+            dist.subtree_size.bin_count = 64;
+            if (tree_distribution(root, &dist) != 0) { printf("ͳʧܣڴ治㣩\n"); break; }
+            print_histogram("ڵĶ", &dist.degree);
+            print_histogram("Ҷ", &dist.leaf_depth);
+            print_histogram("С", &dist.subtree_size);
+            break;
+        }
+
+        case 15:
+            if (!pending) { printf("ûڽеĺ̨ء\n"); break; }
+            {
+                TreeLoadProgress pr;
+                tree_load_progress(pending, &pr);
+                printf("Ѷȡ %zu / %zu ֽڣѴ %zu / %zu ڵ㡣\n",
+                    pr.bytes_done, pr.bytes_total, pr.nodes_done, pr.nodes_total);
+            }
+            break;
+
+        case 16:
+            if (!pending) { printf("ûڽеĺ̨ء\n"); break; }
+            tree_load_cancel(pending);
+            finish_load(&pending, &root, &root_is_block);
+            break;
+
+        case 17:
+        {
+            if (!root) { printf("ȴһ\n"); break; }
+            TreeMemoryUsage usage = tree_memory_usage(root);
+            printf("ڵ %zu ṹ %zu ֽڣַ %zu ֽڣϼ %zu ֽ\n",
+                usage.nodes, usage.struct_bytes, usage.string_bytes, usage.struct_bytes + usage.string_bytes);
+            break;
+        }
+
+        case 18: /* ʾضȡļʺϺܴ */
+        {
+            printf("ļÿһڵ㣬# ʾգ: ");
+            if (!fgets(filename, sizeof(filename), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            filename[strcspn(filename, "\n")] = 0; /* ȥз */
+            FILE* fp = fopen(filename, "rb");
+            if (!fp)
+            {
+                printf("޷ļ\n");
+                break;
+            }
+            TreeNode* loaded = tree_create_from_stream(fp);
+            fclose(fp);
+            if (!loaded) { printf("ȡʧܻΪա\n"); break; }
+            release_tree(&root, &root_is_block);
+            root = loaded;
+            root_is_block = 1;
+            printf("ȡɹ\n");
+            break;
+        }
+
+        case 19: /* һαλͳֵЩڵ */
+        {
+            if (!root) { printf("ȴһ\n"); break; }
+            TreeLeafPath leaves[5];
+            TreeRankedNode ranked[5];
+            int found = tree_top_deepest_leaves(root, 5, leaves);
+            if (found < 0) { printf("ͳʧܣڴ治㣩\n"); break; }
+            printf("Ҷ:\n");
+            for (int i = 0; i < found; ++i)
+            {
+                printf("   %zu: ", leaves[i].depth);
+                for (size_t j = 0; j < leaves[i].depth; ++j)
+                {
+                    printf("%s%s", (j > 0) ? " -> " : "", leaves[i].path[j]->data);
+                }
+                printf("\n");
+            }
+            tree_leaf_paths_free(leaves, (size_t)found);
+
+            found = tree_top_degree(root, 5, ranked);
+            printf("Ľڵ:\n");
+            for (int i = 0; i < found; ++i)
+            {
+                printf("  %s: %zu\n", ranked[i].node->data, ranked[i].value);
+            }
+
+            found = tree_top_subtrees(root, 5, ranked);
+            printf(":\n");
+            for (int i = 0; i < found; ++i)
+            {
+                printf("  %s: %zu ڵ\n", ranked[i].node->data, ranked[i].value);
+            }
+            break;
+        }
+
+        case 20: /* Ƶһڴ棬ԭͷ */
+        {
+            if (!root) { printf("ȴһ\n"); break; }
+            printf("ڵ: ");
+            if (!fgets(filename, sizeof(filename), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            filename[strcspn(filename, "\n")] = 0; /* ȥз */
+            const TreeNode* node = tree_find_by_data(root, filename);
+            if (!node) { printf("δҵýڵ㡣\n"); break; }
+            TreeNode* sub = tree_extract_subtree(node);
+            if (!sub) { printf("ȡʧܣڴ治㣩\n"); break; }
+            release_tree(&root, &root_is_block);
+            root = sub;
+            root_is_block = 1;
+            printf("ȡ %zu ڵ㡣\n", tree_memory_usage(root).nodes);
+            break;
+        }
+
+        case 21: /* ϵͳĲݣʱ佨 */
+        {
+            printf("ѡʽ1: ÿС  ǩ -1 ʾ2: ÿС ӱš: ");
+            if (!fgets(choice_buf, sizeof(choice_buf), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            int format = atoi(choice_buf);
+            if (format != 1 && format != 2) { printf("Чĸʽ\n"); break; }
+            printf("ļ·: ");
+            if (!fgets(filename, sizeof(filename), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            filename[strcspn(filename, "\n")] = 0; /* ȥз */
+            FILE* fp = fopen(filename, "rb");
+            if (!fp)
+            {
+                printf("޷ļ\n");
+                break;
+            }
+            TreeNode* loaded = (format == 1) ? tree_create_from_parent_array(fp) : tree_create_from_edge_list(fp);
+            fclose(fp);
+            if (!loaded) { printf("ʧܣʽ󡢱ظδ塢ڻڴ治㣩\n"); break; }
+            release_tree(&root, &root_is_block);
+            root = loaded;
+            root_is_block = 1;
+            printf("سɹ %zu ڵ㡣\n", tree_memory_usage(root).nodes);
+            break;
+        }
+
+        case 22: /* Ϊ buildTreeFromFile ʽGraphviz  JSON */
+        {
+            if (!root) { printf("ȴһ\n"); break; }
+            printf("ѡʽ1: ʽѡ 2 أ2: DOT3: JSON: ");
+            if (!fgets(choice_buf, sizeof(choice_buf), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            int format = atoi(choice_buf);
+            if (format < 1 || format > 3) { printf("Чĸʽ\n"); break; }
+            printf("ļ·: ");
+            if (!fgets(filename, sizeof(filename), stdin))
+            {
+                clearerr(stdin);
+                continue;
+            }
+            filename[strcspn(filename, "\n")] = 0; /* ȥз */
+            FILE* fp = fopen(filename, "wb");
+            if (!fp)
+            {
+                printf("޷ļ\n");
+                break;
+            }
+            int rc = (format == 1) ? tree_write_index(root, fp) : (format == 2) ? tree_write_dot(root, fp) : tree_write_json(root, fp);
+            fclose(fp);
+            if (rc != 0)
+            {
+                printf("ʧܣдڴ治㣬ʽнڵΪահף\n");
+                break;
+            }
+            printf("ɹ\n");
+            break;
+        }
+
         case 0:
-            if (root) tree_free(root);
+            if (pending)
+            {
+                tree_load_cancel(pending);
+                tree_free(tree_load_finish(pending, NULL));
+            }
+            release_tree(&root, &root_is_block);
             printf("˳\n");
             return 0;
 
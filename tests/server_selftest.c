@@ -0,0 +1,442 @@
+/*
+ * ѯԼ죨 Linux򹹽
+ *   gcc -std=c99 -O2 -I. -o server_selftest tests/server_selftest.c tree*.c -lpthread
+ *   ./server_selftest [׽] [ڵ] [ڵ]
+ * ֱһӵĿһĵд buildTreeFromFile ʽ
+ * η STATSANCESTORRELOADSTATS¼ѭ̷߳ SIGINT رղͷš
+ * RELOAD ڷڲͷžرʱͷŵǰ·ڼ϶ܱջ
+ * ͬʱˮߵ STATSRELOADSTATS¼غϲÿӦ԰򷵻ء
+ * ȫͨ 0
+ */
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "tree_server.h"
+
+#define RESP_MAX 4096
+
+typedef struct ServeRun
+{
+    TreeServer* server;
+    int rc;
+} ServeRun;
+
+static void* serve_main(void* arg)
+{
+    ServeRun* r = (ServeRun*)arg;
+    r->rc = tree_server_run(r->server);
+    return NULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void put_u32(char* p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static uint32_t get_u32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t get_u64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* wide ʱΪһ nodes-1 ӣΪ nodes ĵ */
+static int write_tree(const char* path, uint32_t nodes, int wide)
+{
+    FILE* fp = fopen(path, "w");
+    if (!fp)
+    {
+        return -1;
+    }
+    setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
+    fprintf(fp, "%u\n", nodes);
+    for (uint32_t i = 0; i < nodes; ++i)
+    {
+        long child = -1;
+        long sibling = -1;
+        if (wide)
+        {
+            if (i == 0 && nodes > 1)
+            {
+                child = 1;
+            }
+            else if (i > 0 && i + 1 < nodes)
+            {
+                sibling = (long)i + 1;
+            }
+        }
+        else if (i + 1 < nodes)
+        {
+            child = (long)i + 1;
+        }
+        fprintf(fp, "%s %ld %ld\n", (i == 0) ? "root" : "n", child, sibling);
+    }
+
+    int rc = ferror(fp) ? -1 : 0;
+    if (fclose(fp) != 0)
+    {
+        rc = -1;
+    }
+    return rc;
+}
+
+static int connect_to(const char* path)
+{
+    struct sockaddr_un addr;
+    size_t len = strlen(path);
+    if (len >= sizeof(addr.sun_path))
+    {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, len + 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int io_full(int fd, char* p, size_t n, int writing)
+{
+    while (n > 0)
+    {
+        ssize_t k = writing ? send(fd, p, n, MSG_NOSIGNAL) : read(fd, p, n);
+        if (k < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (k <= 0)
+        {
+            return -1;
+        }
+        p += k;
+        n -= (size_t)k;
+    }
+    return 0;
+}
+
+/* һ󲢶Ӧ resp֡ͷӦ״̬ͨʧܷ -1 */
+static int query(int fd, uint32_t id, TreeQueryOp op, const char* arg, uint32_t arglen, char* resp, uint32_t* resp_len)
+{
+    char req[64];
+    put_u32(req, 5 + arglen);
+    put_u32(req + 4, id);
+    req[8] = (char)op;
+    if (arglen > 0)
+    {
+        memcpy(req + 9, arg, arglen);
+    }
+    if (io_full(fd, req, 9 + arglen, 1) != 0)
+    {
+        return -1;
+    }
+
+    char head[9];
+    if (io_full(fd, head, sizeof(head), 0) != 0)
+    {
+        return -1;
+    }
+    uint32_t len = get_u32(head);
+    if (len < 5 || len - 5 > RESP_MAX || get_u32(head + 4) != id)
+    {
+        return -1;
+    }
+    *resp_len = len - 5;
+    if (io_full(fd, resp, *resp_len, 0) != 0)
+    {
+        return -1;
+    }
+    return (unsigned char)head[8];
+}
+
+/* STATS ĽڵӦɵһ */
+static int check_stats(int fd, uint32_t id, uint32_t nodes, int wide)
+{
+    char resp[RESP_MAX];
+    uint32_t len;
+    if (query(fd, id, TREE_OP_STATS, NULL, 0, resp, &len) != TREE_QUERY_OK || len < 28)
+    {
+        return -1;
+    }
+    uint32_t depth = wide ? ((nodes > 1) ? 2 : 1) : nodes;
+    return (get_u64(resp) == nodes && get_u32(resp + 20) == depth) ? 0 : -1;
+}
+
+/* һڵмڵȣϿԽΪͬʱΪ */
+static int check_ancestor(int fd, uint32_t id, uint32_t nodes, int wide)
+{
+    uint32_t a = nodes - 1;
+    uint32_t b = nodes / 2;
+    char arg[8];
+    char resp[RESP_MAX];
+    uint32_t len;
+    put_u32(arg, a);
+    put_u32(arg + 4, b);
+    if (query(fd, id, TREE_OP_ANCESTOR, arg, sizeof(arg), resp, &len) != TREE_QUERY_OK || len < 5)
+    {
+        return -1;
+    }
+    int is_ancestor = (a == b) || (wide && a == 0);
+    uint32_t lca = (a == b) ? a : (wide ? 0 : b);
+    return (resp[0] == (char)is_ancestor && get_u32(resp + 1) == lca) ? 0 : -1;
+}
+
+static int check_reload(int fd, uint32_t id, uint32_t nodes)
+{
+    char resp[RESP_MAX];
+    uint32_t len;
+    if (query(fd, id, TREE_OP_RELOAD, NULL, 0, resp, &len) != TREE_QUERY_OK || len < 8)
+    {
+        return -1;
+    }
+    return (get_u64(resp) == nodes) ? 0 : -1;
+}
+
+#define RELOAD_CLIENTS 8
+#define RELOAD_ROUNDS 4
+
+typedef struct ReloadClient
+{
+    const char* socket_path;
+    uint32_t nodes;
+    int failed;
+} ReloadClient;
+
+/* ÿһд֡RELOAD ͬһм䣬 STATS ɹ߳ϼ */
+static void* reload_client_main(void* arg)
+{
+    ReloadClient* rc = (ReloadClient*)arg;
+    int fd = connect_to(rc->socket_path);
+    if (fd < 0)
+    {
+        rc->failed = 1;
+        return NULL;
+    }
+
+    for (uint32_t round = 0; round < RELOAD_ROUNDS && !rc->failed; ++round)
+    {
+        char req[27];
+        const TreeQueryOp ops[3] = { TREE_OP_STATS, TREE_OP_RELOAD, TREE_OP_STATS };
+        for (int i = 0; i < 3; ++i)
+        {
+            put_u32(req + i * 9, 5);
+            put_u32(req + i * 9 + 4, round * 3 + (uint32_t)i);
+            req[i * 9 + 8] = (char)ops[i];
+        }
+        if (io_full(fd, req, sizeof(req), 1) != 0)
+        {
+            rc->failed = 1;
+            break;
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            char head[9];
+            char resp[RESP_MAX];
+            if (io_full(fd, head, sizeof(head), 0) != 0)
+            {
+                rc->failed = 1;
+                break;
+            }
+            uint32_t len = get_u32(head);
+            if (len < 5 + 8 || len - 5 > RESP_MAX || io_full(fd, resp, len - 5, 0) != 0
+                || get_u32(head + 4) != round * 3 + (uint32_t)i || head[8] != TREE_QUERY_OK
+                || get_u64(resp) != rc->nodes)
+            {
+                rc->failed = 1;
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return NULL;
+}
+
+static int run_concurrent_reload(const char* socket_path, const char* tree_path, uint32_t nodes)
+{
+    if (write_tree(tree_path, nodes, 1) != 0)
+    {
+        printf("¼أ޷д %s\n", tree_path);
+        return -1;
+    }
+
+    ServeRun run;
+    run.server = tree_server_create(socket_path, tree_path, 4);
+    run.rc = -1;
+    pthread_t thread;
+    if (!run.server || pthread_create(&thread, NULL, serve_main, &run) != 0)
+    {
+        printf("¼أʧܡ\n");
+        tree_server_free(run.server);
+        unlink(tree_path);
+        return -1;
+    }
+
+    double t0 = now_seconds();
+    ReloadClient clients[RELOAD_CLIENTS];
+    pthread_t threads[RELOAD_CLIENTS];
+    int started = 0;
+    int failed = 0;
+    for (int i = 0; i < RELOAD_CLIENTS; ++i)
+    {
+        clients[i].socket_path = socket_path;
+        clients[i].nodes = nodes;
+        clients[i].failed = 0;
+        if (pthread_create(&threads[i], NULL, reload_client_main, &clients[i]) != 0)
+        {
+            failed = 1;
+            break;
+        }
+        started++;
+    }
+    for (int i = 0; i < started; ++i)
+    {
+        pthread_join(threads[i], NULL);
+        failed |= clients[i].failed;
+    }
+    double elapsed = now_seconds() - t0;
+
+    tree_server_stop(run.server);
+    pthread_join(thread, NULL);
+    tree_server_free(run.server);
+    unlink(tree_path);
+
+    if (failed || run.rc != 0)
+    {
+        printf("¼أ%d   %d ֣ʧܡ\n", RELOAD_CLIENTS, RELOAD_ROUNDS);
+        return -1;
+    }
+    printf("¼أ%d   %d ֣%u ڵ㣩ͨʱ %.3f \n",
+        RELOAD_CLIENTS, RELOAD_ROUNDS, nodes, elapsed);
+    return 0;
+}
+
+static int run_case(const char* socket_path, const char* tree_path, uint32_t nodes, int wide)
+{
+    const char* name = wide ? "" : "";
+    if (write_tree(tree_path, nodes, wide) != 0)
+    {
+        printf("%s޷д %s\n", name, tree_path);
+        return -1;
+    }
+
+    double t0 = now_seconds();
+    ServeRun run;
+    run.server = tree_server_create(socket_path, tree_path, 2);
+    run.rc = -1;
+    if (!run.server)
+    {
+        printf("%sʧܡ\n", name);
+        unlink(tree_path);
+        return -1;
+    }
+    double load = now_seconds() - t0;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, serve_main, &run) != 0)
+    {
+        tree_server_free(run.server);
+        unlink(tree_path);
+        return -1;
+    }
+
+    int failed = 0;
+    double reload = 0.0;
+    int fd = connect_to(socket_path);
+    if (fd < 0 || check_stats(fd, 1, nodes, wide) != 0 || check_ancestor(fd, 2, nodes, wide) != 0)
+    {
+        failed = 1;
+    }
+    if (!failed)
+    {
+        t0 = now_seconds();
+        failed = (check_reload(fd, 3, nodes) != 0);
+        reload = now_seconds() - t0;
+    }
+    if (!failed && check_stats(fd, 4, nodes, wide) != 0)
+    {
+        failed = 1;
+    }
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    /*  Ctrl+C ͬĹر·źֻ¼ѭ̣߳ signalfd  */
+    t0 = now_seconds();
+    if (failed)
+    {
+        tree_server_stop(run.server);
+    }
+    else
+    {
+        pthread_kill(thread, SIGINT);
+    }
+    pthread_join(thread, NULL);
+    tree_server_free(run.server);
+    double stop = now_seconds() - t0;
+    unlink(tree_path);
+
+    if (failed || run.rc != 0)
+    {
+        printf("%s%u ڵ㣩ʧܡ\n", name, nodes);
+        return -1;
+    }
+    printf("%s%u ڵ㣩ͨ %.3f 룬¼ %.3f 룬ر %.3f \n", name, nodes, load, reload, stop);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    const char* socket_path = (argc >= 2) ? argv[1] : "/tmp/tree-selftest.sock";
+    long wide = (argc >= 3) ? atol(argv[2]) : 1000001L;
+    long deep = (argc >= 4) ? atol(argv[3]) : 3000000L;
+    if (wide <= 0 || deep <= 0 || wide >= (long)TREE_NO_NODE || deep >= (long)TREE_NO_NODE)
+    {
+        printf("ڵΪС %u\n", TREE_NO_NODE);
+        return 1;
+    }
+
+    char tree_path[512];
+    snprintf(tree_path, sizeof(tree_path), "%s.tree", socket_path);
+
+    int failed = 0;
+    failed |= (run_case(socket_path, tree_path, (uint32_t)wide, 1) != 0);
+    failed |= (run_case(socket_path, tree_path, (uint32_t)deep, 0) != 0);
+    failed |= (run_concurrent_reload(socket_path, tree_path, (uint32_t)wide) != 0);
+    return failed ? 1 : 0;
+}
@@ -1,8 +1,91 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 #include "tree.h"
+#include "tree_internal.h"
+#include "tree_traverse.h"
+
+/* ǰalloc_fn Ϊ NULL ʱʹ C п */
+static TreeAllocator g_allocator = { NULL, NULL, NULL, NULL };
+
+/* صڴԤ㣬0 ʾ */
+static size_t g_memory_budget = 0;
+
+void tree_set_allocator(const TreeAllocator* allocator)
+{
+    if (allocator && allocator->alloc_fn && allocator->realloc_fn && allocator->free_fn)
+    {
+        g_allocator = *allocator;
+    }
+    else
+    {
+        g_allocator.alloc_fn = NULL;
+        g_allocator.realloc_fn = NULL;
+        g_allocator.free_fn = NULL;
+        g_allocator.ctx = NULL;
+    }
+}
+
+void* tree_mem_alloc(size_t size)
+{
+    if (g_allocator.alloc_fn)
+    {
+        return g_allocator.alloc_fn(g_allocator.ctx, size);
+    }
+    return malloc(size);
+}
+
+void* tree_mem_calloc(size_t count, size_t size)
+{
+    /* ֹ count * size  */
+    if (size != 0 && count > (size_t)-1 / size)
+    {
+        return NULL;
+    }
+
+    void* p = tree_mem_alloc(count * size);
+    if (p)
+    {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+void* tree_mem_realloc(void* ptr, size_t size)
+{
+    if (g_allocator.realloc_fn)
+    {
+        return g_allocator.realloc_fn(g_allocator.ctx, ptr, size);
+    }
+    return realloc(ptr, size);
+}
+
+void tree_mem_free(void* ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    if (g_allocator.free_fn)
+    {
+        g_allocator.free_fn(g_allocator.ctx, ptr);
+        return;
+    }
+    free(ptr);
+}
+
+void tree_set_memory_budget(size_t bytes)
+{
+    g_memory_budget = bytes;
+}
+
+size_t tree_get_memory_budget(void)
+{
+    return g_memory_budget;
+}
 
 /* Ұȫַƣƽ̨ strdup һ£ */
 static char* strdup_s(const char* s)
@@ -13,7 +96,7 @@ static char* strdup_s(const char* s)
     }
 
     size_t len = strlen(s) + 1;
-    char* dup = (char*)malloc(len);
+    char* dup = (char*)tree_mem_alloc(len);
     if (!dup)
     {
         return NULL;
@@ -26,7 +109,7 @@ static char* strdup_s(const char* s)
 /* ڵ */
 TreeNode* tree_create_node(const char* data)
 {
-    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    TreeNode* node = (TreeNode*)tree_mem_alloc(sizeof(TreeNode));
     if (!node)
     {
         return NULL;
@@ -41,25 +124,27 @@ TreeNode* tree_create_node(const char* data)
 /* ͷ node һֵ㣩 */
 void tree_free(TreeNode* root)
 {
-    if (!root)
-    {
-        return;
-    }
-
-    /* ͷź */
-    if (root->first_child)
-    {
-        tree_free(root->first_child);
-    }
-
-    /* ͷֵ */
-    if (root->next_sibling)
+    /*
+     * ǵݹͷţѺתǰڵ֮ǰӵֵָָظڵ㣩
+     * ûкӵĽڵ㼴ͷŲֵָռռ䣬ᱬջ
+     */
+    while (root)
     {
-        tree_free(root->next_sibling);
+        TreeNode* child = root->first_child;
+        if (child)
+        {
+            root->first_child = child->next_sibling;
+            child->next_sibling = root;
+            root = child;
+        }
+        else
+        {
+            TreeNode* next = root->next_sibling;
+            tree_mem_free(root->data);
+            tree_mem_free(root);
+            root = next;
+        }
     }
-
-    free(root->data);
-    free(root);
 }
 
 /* ӿ̨򻯽ֻڵ㣻ɰչ */
@@ -126,6 +211,363 @@ TreeNode* tree_create_from_console(void)
     return tree_create_from_console_internal("ڵݣ#ʾգ");
 }
 
+/*
+ * ʾȡ̨ͬı룺ÿһڵݣ "#" ʾգ
+ * ڼڵһУֶݴ桰± + 1data ݴַƫƣ
+ * ַڽڵ֮ϲΪһڴ棬ٰ±껻ָ롣
+ * λʽջ棺ջԪΪ ڵ± * 2 + (0  / 1 ֵ)
+ * ջ൱ģľջ
+ */
+#define STREAM_READ_CHUNK (1 << 20)
+#define STREAM_SLOT_ROOT ((size_t)-1)
+
+typedef struct StreamBuilder
+{
+    TreeNode* nodes;
+    size_t count;
+    size_t node_cap;
+
+    char* strings;
+    size_t str_len;
+    size_t str_cap;
+
+    size_t* slots;
+    size_t sp;
+    size_t slot_cap;
+
+    size_t token_start;   /* ǰ strings е */
+    size_t budget;
+    int done;             /* ݺ */
+} StreamBuilder;
+
+static int stream_reserve(void** buf, size_t* cap, size_t need, size_t elem)
+{
+    if (need <= *cap)
+    {
+        return 1;
+    }
+
+    size_t newcap = (*cap == 0) ? 1024 : *cap;
+    while (newcap < need)
+    {
+        newcap *= 2;
+    }
+
+    void* p = tree_mem_realloc(*buf, newcap * elem);
+    if (!p)
+    {
+        return 0;
+    }
+    *buf = p;
+    *cap = newcap;
+    return 1;
+}
+
+static int stream_push_slot(StreamBuilder* b, size_t slot)
+{
+    if (!stream_reserve((void**)&b->slots, &b->slot_cap, b->sp + 1, sizeof(size_t)))
+    {
+        return 0;
+    }
+    b->slots[b->sp++] = slot;
+    return 1;
+}
+
+/* һж꣺strings[token_start..str_len) ΪݣУ */
+static int stream_end_token(StreamBuilder* b)
+{
+    size_t len = b->str_len - b->token_start;
+    char* tok = b->strings + b->token_start;
+
+    /* ȥ CRLF е '\r' */
+    while (len > 0 && tok[len - 1] == '\r')
+    {
+        len--;
+    }
+    b->str_len = b->token_start + len;
+
+    size_t slot = b->slots[--b->sp];
+    if (len == 1 && tok[0] == '#')
+    {
+        b->str_len = b->token_start;
+        b->done = (b->sp == 0);
+        return 1;
+    }
+
+    if (!stream_reserve((void**)&b->strings, &b->str_cap, b->str_len + 1, 1) ||
+        !stream_reserve((void**)&b->nodes, &b->node_cap, b->count + 1, sizeof(TreeNode)))
+    {
+        return 0;
+    }
+    b->strings[b->str_len++] = '\0';
+
+    size_t idx = b->count++;
+    TreeNode* node = &b->nodes[idx];
+    node->data = (char*)(uintptr_t)b->token_start;
+    node->first_child = NULL;
+    node->next_sibling = NULL;
+
+    if (slot != STREAM_SLOT_ROOT)
+    {
+        TreeNode* parent = &b->nodes[slot / 2];
+        TreeNode* link = (TreeNode*)(uintptr_t)(idx + 1);
+        if (slot % 2 == 0)
+        {
+            parent->first_child = link;
+        }
+        else
+        {
+            parent->next_sibling = link;
+        }
+    }
+
+    if (b->budget != 0 && b->count * sizeof(TreeNode) + b->str_len > b->budget)
+    {
+        return 0;
+    }
+
+    /* ѹֵλãѹλãһ */
+    b->token_start = b->str_len;
+    return stream_push_slot(b, idx * 2 + 1) && stream_push_slot(b, idx * 2);
+}
+
+static void stream_builder_free(StreamBuilder* b)
+{
+    tree_mem_free(b->nodes);
+    tree_mem_free(b->strings);
+    tree_mem_free(b->slots);
+}
+
+TreeNode* tree_create_from_stream(FILE* fp)
+{
+    if (!fp)
+    {
+        return NULL;
+    }
+
+    StreamBuilder b;
+    memset(&b, 0, sizeof(b));
+    b.budget = tree_get_memory_budget();
+
+    char* chunk = (char*)tree_mem_alloc(STREAM_READ_CHUNK);
+    if (!chunk || !stream_push_slot(&b, STREAM_SLOT_ROOT))
+    {
+        tree_mem_free(chunk);
+        stream_builder_free(&b);
+        return NULL;
+    }
+
+    int ok = 1;
+    size_t got;
+    while (ok && !b.done && (got = fread(chunk, 1, STREAM_READ_CHUNK, fp)) > 0)
+    {
+        const char* p = chunk;
+        const char* end = chunk + got;
+        while (p < end)
+        {
+            const char* nl = (const char*)memchr(p, '\n', (size_t)(end - p));
+            const char* stop = nl ? nl : end;
+            size_t n = (size_t)(stop - p);
+
+            /* ֱ׷ӵַȻƴ */
+            if (!stream_reserve((void**)&b.strings, &b.str_cap, b.str_len + n + 1, 1))
+            {
+                ok = 0;
+                break;
+            }
+            memcpy(b.strings + b.str_len, p, n);
+            b.str_len += n;
+
+            if (!nl)
+            {
+                break;
+            }
+
+            p = nl + 1;
+            if (!stream_end_token(&b))
+            {
+                ok = 0;
+                break;
+            }
+            if (b.done)
+            {
+                break;
+            }
+        }
+    }
+
+    /* һпûлзEOF ʱδλðմ̨һ£ */
+    if (ok && !b.done && b.str_len > b.token_start)
+    {
+        ok = stream_end_token(&b);
+    }
+
+    tree_mem_free(chunk);
+    if (!ok || b.count == 0)
+    {
+        stream_builder_free(&b);
+        return NULL;
+    }
+
+    /* ϲΪһ飺ڵǰַ */
+    size_t node_bytes = b.count * sizeof(TreeNode);
+    TreeNode* block = (TreeNode*)tree_mem_realloc(b.nodes, node_bytes + b.str_len);
+    if (!block)
+    {
+        stream_builder_free(&b);
+        return NULL;
+    }
+    b.nodes = NULL;
+
+    char* text = (char*)block + node_bytes;
+    memcpy(text, b.strings, b.str_len);
+    for (size_t i = 0; i < b.count; ++i)
+    {
+        TreeNode* n = &block[i];
+        size_t fc = (size_t)(uintptr_t)n->first_child;
+        size_t ns = (size_t)(uintptr_t)n->next_sibling;
+        n->data = text + (size_t)(uintptr_t)n->data;
+        n->first_child = fc ? &block[fc - 1] : NULL;
+        n->next_sibling = ns ? &block[ns - 1] : NULL;
+    }
+
+    stream_builder_free(&b);
+    return block;
+}
+
+void tree_free_block(TreeNode* root)
+{
+    tree_mem_free(root);
+}
+
+/* ʱջ֡src ΪƵֵα꣬slot Ϊ丱Ӧҽӵλ */
+typedef struct CloneFrame
+{
+    const TreeNode* src;
+    TreeNode** slot;
+} CloneFrame;
+
+/*
+ * 鸴ƣһͳƽڵַܳڶ鰴ѽڵַдͬһڴ档
+ * with_siblings Ϊ 0 ʱֻ root 鶼ʽջȫ
+ */
+static TreeNode* clone_block(const TreeNode* root, int with_siblings)
+{
+    if (!root)
+    {
+        return NULL;
+    }
+
+    CloneFrame local[128];
+    CloneFrame* stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+    size_t count = 0;
+    size_t text_bytes = 0;
+    TreeNode* block = NULL;
+    TreeNode* result = NULL;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        char* text = NULL;
+        size_t next = 0;
+        if (pass == 1)
+        {
+            block = (TreeNode*)tree_mem_alloc(count * sizeof(TreeNode) + text_bytes);
+            if (!block)
+            {
+                break;
+            }
+            text = (char*)(block + count);
+        }
+
+        sp = 0;
+        stack[sp].src = root;
+        stack[sp].slot = &result;
+        sp++;
+
+        while (sp > 0)
+        {
+            CloneFrame* f = &stack[sp - 1];
+            const TreeNode* n = f->src;
+            if (!n)
+            {
+                sp--;
+                continue;
+            }
+
+            /* ֻʱײ㲻ֵǰ */
+            f->src = (sp == 1 && !with_siblings) ? NULL : n->next_sibling;
+
+            TreeNode* copy = NULL;
+            if (pass == 0)
+            {
+                count++;
+                if (n->data)
+                {
+                    text_bytes += strlen(n->data) + 1;
+                }
+            }
+            else
+            {
+                copy = &block[next++];
+                *f->slot = copy;
+                f->slot = &copy->next_sibling;
+                copy->data = NULL;
+                copy->first_child = NULL;
+                copy->next_sibling = NULL;
+                if (n->data)
+                {
+                    size_t len = strlen(n->data) + 1;
+                    memcpy(text, n->data, len);
+                    copy->data = text;
+                    text += len;
+                }
+            }
+
+            if (n->first_child)
+            {
+                if (sp >= cap)
+                {
+                    CloneFrame* ns = (CloneFrame*)tree_traverse_grow(stack, local, &cap, sizeof(CloneFrame), sp);
+                    if (!ns)
+                    {
+                        tree_mem_free(block);
+                        block = NULL;
+                        break;
+                    }
+                    stack = ns;
+                }
+                stack[sp].src = n->first_child;
+                stack[sp].slot = copy ? &copy->first_child : NULL;
+                sp++;
+            }
+        }
+
+        if (sp > 0)
+        {
+            /* չջʧ */
+            break;
+        }
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free(stack);
+    }
+    return block ? result : NULL;
+}
+
+TreeNode* tree_clone(const TreeNode* root)
+{
+    return clone_block(root, 1);
+}
+
+TreeNode* tree_extract_subtree(const TreeNode* node)
+{
+    return clone_block(node, 0);
+}
+
 /* ڵڵ㼰ֵܣ */
 size_t tree_count_nodes(const TreeNode* root)
 {
@@ -137,6 +579,57 @@ size_t tree_count_nodes(const TreeNode* root)
     return 1 + tree_count_nodes(root->first_child) + tree_count_nodes(root->next_sibling);
 }
 
+/* ڴռã㱣ֵα꣬ǵݹ */
+TreeMemoryUsage tree_memory_usage(const TreeNode* root)
+{
+    TreeMemoryUsage usage = { 0, 0, 0 };
+    const TreeNode* local[128];
+    const TreeNode** stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+
+    stack[sp++] = root;
+    while (sp > 0)
+    {
+        const TreeNode* n = stack[sp - 1];
+        if (!n)
+        {
+            sp--;
+            continue;
+        }
+
+        stack[sp - 1] = n->next_sibling;
+        usage.nodes++;
+        if (n->data)
+        {
+            usage.string_bytes += strlen(n->data) + 1;
+        }
+
+        if (n->first_child)
+        {
+            if (sp >= cap)
+            {
+                const TreeNode** ns = (const TreeNode**)tree_traverse_grow((void*)stack, local, &cap, sizeof(*stack), sp);
+                if (!ns)
+                {
+                    /* ڴ治ʱֻͳѷʵĲ */
+                    break;
+                }
+                stack = ns;
+            }
+            stack[sp++] = n->first_child;
+        }
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free((void*)stack);
+    }
+
+    usage.struct_bytes = usage.nodes * sizeof(TreeNode);
+    return usage;
+}
+
 /* ҶڵûкӵĽڵ㣩 */
 size_t tree_count_leaves(const TreeNode* root)
 {
@@ -275,7 +768,7 @@ void tree_level_order(const TreeNode* root, void (*visit)(const TreeNode*))
     size_t cap = 128;
     size_t head = 0;
     size_t tail = 0;
-    TreeNode** queue = (TreeNode**)malloc(sizeof(TreeNode*) * cap);
+    TreeNode** queue = (TreeNode**)tree_mem_alloc(sizeof(TreeNode*) * cap);
     if (!queue)
     {
         return;
@@ -288,7 +781,7 @@ void tree_level_order(const TreeNode* root, void (*visit)(const TreeNode*))
         if (tail >= cap)
         {
             cap *= 2;
-            queue = (TreeNode**)realloc(queue, sizeof(TreeNode*) * cap);
+            queue = (TreeNode**)tree_mem_realloc(queue, sizeof(TreeNode*) * cap);
             if (!queue)
             {
                 return;
@@ -313,7 +806,7 @@ void tree_level_order(const TreeNode* root, void (*visit)(const TreeNode*))
             if (tail >= cap)
             {
                 cap *= 2;
-                queue = (TreeNode**)realloc(queue, sizeof(TreeNode*) * cap);
+                queue = (TreeNode**)tree_mem_realloc(queue, sizeof(TreeNode*) * cap);
                 if (!queue)
                 {
                     return;
@@ -324,7 +817,7 @@ void tree_level_order(const TreeNode* root, void (*visit)(const TreeNode*))
         }
     }
 
-    free(queue);
+    tree_mem_free(queue);
 }
 
 /*  data ַҽڵ㣨׸ƥ */
@@ -387,20 +880,44 @@ const TreeNode* tree_find_by_data(const TreeNode* root, const char* data)
 - Ҫֺ֧ոݣӦΪֶλŰĽﰴĿҪʵּ򵥽
 */
 
-TreeNode* buildTreeFromFile(const char* filename)
+/* ʧʱͷѴĽڵ㼰 */
+static void build_tree_cleanup(TreeNode** nodes, int count, int* child_idx, int* sibling_idx)
 {
-    if (!filename)
+    for (int j = 0; j < count; ++j)
     {
-        return NULL;
+        if (nodes[j])
+        {
+            tree_mem_free(nodes[j]->data);
+            tree_mem_free(nodes[j]);
+        }
     }
+    tree_mem_free(nodes);
+    tree_mem_free(child_idx);
+    tree_mem_free(sibling_idx);
+}
 
-    FILE* fp = fopen(filename, "r");
+/* ֪ͨؽȣط 0 ʾҪȡ */
+static int build_tree_report(const TreeLoadMonitor* monitor, size_t bytes, size_t nodes, size_t total)
+{
+    if (!monitor || !monitor->on_progress)
+    {
+        return 0;
+    }
+    return monitor->on_progress(monitor->ctx, bytes, nodes, total);
+}
+
+/* ÿȡٸڵ㱨һν */
+#define BUILD_TREE_REPORT_EVERY 4096
+
+TreeNode* tree_build_from_fp(FILE* fp, const TreeLoadMonitor* monitor)
+{
     if (!fp)
     {
         return NULL;
     }
 
     char line[512];
+    size_t bytes = 0;
 
     /* ȡһУڵհ */
     int n = -1;
@@ -408,6 +925,7 @@ TreeNode* buildTreeFromFile(const char* filename)
     {
         /* ȥĩ */
         size_t len = strlen(line);
+        bytes += len;
         while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
         {
             line[--len] = '\0';
@@ -432,38 +950,53 @@ TreeNode* buildTreeFromFile(const char* filename)
         else
         {
             /* һиʽ */
-            fclose(fp);
             return NULL;
         }
     }
 
     if (n <= 0)
     {
-        fclose(fp);
+        return NULL;
+    }
+
+    /*
+     * ÿڵռһṹһַֹڼиеһָ±ꣻ
+     * ½ԤԤʧ
+     */
+    size_t budget = tree_get_memory_budget();
+    size_t aux_per_node = sizeof(TreeNode*) + 2 * sizeof(int);
+    if (budget != 0 && (size_t)n > budget / (sizeof(TreeNode) + 2 + aux_per_node))
+    {
+        return NULL;
+    }
+
+    if (build_tree_report(monitor, bytes, 0, (size_t)n))
+    {
         return NULL;
     }
 
     /* 丨 */
-    TreeNode** nodes = (TreeNode**)calloc((size_t)n, sizeof(TreeNode*));
-    int* child_idx = (int*)malloc(sizeof(int) * (size_t)n);
-    int* sibling_idx = (int*)malloc(sizeof(int) * (size_t)n);
+    TreeNode** nodes = (TreeNode**)tree_mem_calloc((size_t)n, sizeof(TreeNode*));
+    int* child_idx = (int*)tree_mem_alloc(sizeof(int) * (size_t)n);
+    int* sibling_idx = (int*)tree_mem_alloc(sizeof(int) * (size_t)n);
 
     if (!nodes || !child_idx || !sibling_idx)
     {
-        /* ͷѷ */
-        if (nodes) free(nodes);
-        if (child_idx) free(child_idx);
-        if (sibling_idx) free(sibling_idx);
-        fclose(fp);
+        /* ͷѷ */
+        tree_mem_free(nodes);
+        tree_mem_free(child_idx);
+        tree_mem_free(sibling_idx);
         return NULL;
     }
 
     /* ʼڵָΪ NULLcalloc  */
     int read_count = 0;
+    size_t tree_bytes = (size_t)n * aux_per_node; /* Ѵڵռõڴ棬Ԥ */
     while (read_count < n && fgets(line, sizeof(line), fp))
     {
         /* ȥĩ */
         size_t len = strlen(line);
+        bytes += len;
         while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r'))
         {
             line[--len] = '\0';
@@ -485,41 +1018,26 @@ TreeNode* buildTreeFromFile(const char* filename)
         char data[256];
         int ci = -1;
         int si = -1;
-        /* ݣ޿ո  */
+        /* ݣ޿ո  ֵ */
         int matched = sscanf(p, "%255s %d %d", data, &ci, &si);
         if (matched != 3)
         {
-            /* ʧܣ */
-            for (int j = 0; j < read_count; ++j)
-            {
-                if (nodes[j])
-                {
-                    free(nodes[j]->data);
-                    free(nodes[j]);
-                }
-            }
-            free(nodes);
-            free(child_idx);
-            free(sibling_idx);
-            fclose(fp);
+            /* ʧܣ */
+            build_tree_cleanup(nodes, read_count, child_idx, sibling_idx);
+            return NULL;
+        }
+
+        tree_bytes += sizeof(TreeNode) + strlen(data) + 1;
+        if (budget != 0 && tree_bytes > budget)
+        {
+            build_tree_cleanup(nodes, read_count, child_idx, sibling_idx);
             return NULL;
         }
 
         TreeNode* node = tree_create_node(data);
         if (!node)
         {
-            for (int j = 0; j < read_count; ++j)
-            {
-                if (nodes[j])
-                {
-                    free(nodes[j]->data);
-                    free(nodes[j]);
-                }
-            }
-            free(nodes);
-            free(child_idx);
-            free(sibling_idx);
-            fclose(fp);
+            build_tree_cleanup(nodes, read_count, child_idx, sibling_idx);
             return NULL;
         }
 
@@ -527,65 +1045,33 @@ TreeNode* buildTreeFromFile(const char* filename)
         child_idx[read_count] = ci;
         sibling_idx[read_count] = si;
         read_count++;
+
+        /* ڱȲǷȡ */
+        if (read_count % BUILD_TREE_REPORT_EVERY == 0 &&
+            build_tree_report(monitor, bytes, (size_t)read_count, (size_t)n))
+        {
+            build_tree_cleanup(nodes, read_count, child_idx, sibling_idx);
+            return NULL;
+        }
     }
 
     if (read_count != n)
     {
-        /* 㣬 */
-        for (int j = 0; j < read_count; ++j)
-        {
-            if (nodes[j])
-            {
-                free(nodes[j]->data);
-                free(nodes[j]);
-            }
-        }
-        free(nodes);
-        free(child_idx);
-        free(sibling_idx);
-        fclose(fp);
+        /* 㣬 */
+        build_tree_cleanup(nodes, read_count, child_idx, sibling_idx);
         return NULL;
     }
 
-    /* ֤ϷԲָ */
+    /* ֤ϷԲָ */
     for (int i = 0; i < n; ++i)
     {
         int ci = child_idx[i];
         int si = sibling_idx[i];
 
-        if (ci != -1 && (ci < 0 || ci >= n))
+        if ((ci != -1 && (ci < 0 || ci >= n)) || (si != -1 && (si < 0 || si >= n)))
         {
-            /* Ƿ */
-            for (int j = 0; j < n; ++j)
-            {
-                if (nodes[j])
-                {
-                    free(nodes[j]->data);
-                    free(nodes[j]);
-                }
-            }
-            free(nodes);
-            free(child_idx);
-            free(sibling_idx);
-            fclose(fp);
-            return NULL;
-        }
-
-        if (si != -1 && (si < 0 || si >= n))
-        {
-            /* Ƿ */
-            for (int j = 0; j < n; ++j)
-            {
-                if (nodes[j])
-                {
-                    free(nodes[j]->data);
-                    free(nodes[j]);
-                }
-            }
-            free(nodes);
-            free(child_idx);
-            free(sibling_idx);
-            fclose(fp);
+            /* Ƿ */
+            build_tree_cleanup(nodes, n, child_idx, sibling_idx);
             return NULL;
         }
 
@@ -597,10 +1083,28 @@ TreeNode* buildTreeFromFile(const char* filename)
     TreeNode* root = nodes[0];
 
     /* ͷŸ飨ͷŽڵ㣩 */
-    free(nodes);
-    free(child_idx);
-    free(sibling_idx);
+    tree_mem_free(nodes);
+    tree_mem_free(child_idx);
+    tree_mem_free(sibling_idx);
+
+    build_tree_report(monitor, bytes, (size_t)n, (size_t)n);
+    return root;
+}
+
+TreeNode* buildTreeFromFile(const char* filename)
+{
+    if (!filename)
+    {
+        return NULL;
+    }
+
+    FILE* fp = fopen(filename, "r");
+    if (!fp)
+    {
+        return NULL;
+    }
 
+    TreeNode* root = tree_build_from_fp(fp, NULL);
     fclose(fp);
     return root;
 }
@@ -663,7 +1167,7 @@ static void tree_print_shape_print_node(const TreeNode* node, int depth, int** p
         {
             newcap *= 2;
         }
-        int* newflags = (int*)realloc(*pflags, sizeof(int) * (size_t)newcap);
+        int* newflags = (int*)tree_mem_realloc(*pflags, sizeof(int) * (size_t)newcap);
         if (!newflags)
         {
             /* ڴʧܣд flagsٶΪ 0 */
@@ -749,5 +1253,5 @@ void tree_print_shape(const TreeNode* root)
         p = p->next_sibling;
     }
 
-    free(flags);
+    tree_mem_free(flags);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #define TREE_H
 
 #include <stddef.h>
+#include <stdio.h>
 
 typedef struct TreeNode
 {
@@ -13,12 +14,30 @@ typedef struct TreeNode
 
 /*  */
 TreeNode* tree_create_node(const char* data);
-void tree_free(TreeNode* root);
+void tree_free(TreeNode* root);    /* ͷ root ֵܣƬɭ֣ǵݹ */
 
 /* 츨ʵ֣ӿ̨ļ */
 TreeNode* tree_create_from_console(void);
 TreeNode* buildTreeFromFile(const char* filename);
 
+/*
+ * жȡ̨ͬ루ÿһڵݣ"#" ʾգʾ
+ * ȡʽջнڵַλͬһڴУ
+ *  tree_free_block ͷţ tree_freeҲɾеĽڵ㡣
+ * ֹͣжݱԡ
+ */
+TreeNode* tree_create_from_stream(FILE* fp);
+void tree_free_block(TreeNode* root);
+
+/*
+ * Ϊһڴ棺ͳƴСٰƽڵַֻһΡ
+ *  tree_create_from_stream һ tree_free_block ͷţҲɾڵ㡣
+ * tree_clone  root ֵܣƬɭ֣tree_extract_subtree ֻ node 
+ * ڴ治Ϊ NULL ʱ NULL
+ */
+TreeNode* tree_clone(const TreeNode* root);
+TreeNode* tree_extract_subtree(const TreeNode* node);
+
 
 /* ͳ */
 size_t tree_count_nodes(const TreeNode* root);
@@ -41,4 +60,40 @@ void tree_level_order(const TreeNode* root, void (*visit)(const TreeNode*));
 const TreeNode* tree_find_by_data(const TreeNode* root, const char* data);
 void tree_print_shape(const TreeNode* root);
 
+/* Զڴз䶼ctx ԭ */
+typedef struct TreeAllocator
+{
+    void* (*alloc_fn)(void* ctx, size_t size);
+    void* (*realloc_fn)(void* ctx, void* ptr, size_t size);
+    void (*free_fn)(void* ctx, void* ptr);
+    void* ctx;
+} TreeAllocator;
+
+/* ÷NULL ָΪ malloc/realloc/freeӦڴκ֮ǰãлǰڴ治ܽ·ͷ */
+void tree_set_allocator(const TreeAllocator* allocator);
+
+/* ǰ/ͷڴ棬ⷵصڴ涼 tree_mem_free ͷ */
+void* tree_mem_alloc(size_t size);
+void* tree_mem_calloc(size_t count, size_t size);
+void* tree_mem_realloc(void* ptr, size_t size);
+void tree_mem_free(void* ptr);
+
+/* ڴռãڵṹֱַͳƣĿ */
+typedef struct TreeMemoryUsage
+{
+    size_t nodes;
+    size_t struct_bytes;
+    size_t string_bytes;
+} TreeMemoryUsage;
+
+TreeMemoryUsage tree_memory_usage(const TreeNode* root);
+
+/*
+ * صڴԤ㣨ֽڣ0 ʾƣ
+ * ڶڵԤԤʧܣعۼƳʱֹͬ
+ * Ǽڼķֵڵַ֮⣬Լĸ顣
+ */
+void tree_set_memory_budget(size_t bytes);
+size_t tree_get_memory_budget(void);
+
 #endif /* TREE_H */
\ No newline at end of file
@@ -0,0 +1,534 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tree_analytics.h"
+#include "tree_traverse.h"
+
+/* ÿһջ֡cur Ϊһʵĺӣsize/degree Ϊɺӵۼ */
+typedef struct DistFrame
+{
+    const TreeNode* node;
+    const TreeNode* cur;
+    size_t size;
+    size_t degree;
+} DistFrame;
+
+/* ͳƹеۼֵͳһ */
+typedef struct HistAcc
+{
+    TreeHistogram* hist;
+    uint64_t sum;
+} HistAcc;
+
+static void hist_begin(HistAcc* acc, TreeHistogram* hist)
+{
+    acc->hist = hist;
+    acc->sum = 0;
+    hist->samples = 0;
+    hist->max = 0;
+    hist->mean = 0.0;
+    hist->p50 = hist->p90 = hist->p99 = 0;
+    if (hist->bins && hist->bin_count > 0)
+    {
+        memset(hist->bins, 0, sizeof(size_t) * hist->bin_count);
+    }
+}
+
+static void hist_add(HistAcc* acc, size_t v)
+{
+    TreeHistogram* h = acc->hist;
+    h->samples++;
+    acc->sum += v;
+    if (v > h->max)
+    {
+        h->max = v;
+    }
+    if (h->bins && h->bin_count > 0)
+    {
+        h->bins[(v < h->bin_count) ? v : (h->bin_count - 1)]++;
+    }
+}
+
+static void hist_end(HistAcc* acc)
+{
+    TreeHistogram* h = acc->hist;
+    if (h->samples > 0)
+    {
+        h->mean = (double)acc->sum / (double)h->samples;
+    }
+    h->p50 = tree_histogram_percentile(h, 0.50);
+    h->p90 = tree_histogram_percentile(h, 0.90);
+    h->p99 = tree_histogram_percentile(h, 0.99);
+}
+
+size_t tree_histogram_percentile(const TreeHistogram* hist, double p)
+{
+    if (!hist || !hist->bins || hist->bin_count == 0 || hist->samples == 0)
+    {
+        return 0;
+    }
+
+    if (p < 0.0)
+    {
+        p = 0.0;
+    }
+    if (p > 1.0)
+    {
+        p = 1.0;
+    }
+
+    /* ĿΪ ceil(p * samples) ٵ 1  */
+    double want = p * (double)hist->samples;
+    size_t rank = (size_t)want;
+    if ((double)rank < want)
+    {
+        rank++;
+    }
+    if (rank == 0)
+    {
+        rank = 1;
+    }
+
+    size_t seen = 0;
+    for (size_t i = 0; i < hist->bin_count; ++i)
+    {
+        seen += hist->bins[i];
+        if (seen >= rank)
+        {
+            return i;
+        }
+    }
+
+    return hist->bin_count - 1;
+}
+
+int tree_distribution(const TreeNode* root, TreeDistribution* dist)
+{
+    if (!dist)
+    {
+        return -1;
+    }
+
+    HistAcc degree;
+    HistAcc leaf_depth;
+    HistAcc subtree_size;
+    hist_begin(&degree, &dist->degree);
+    hist_begin(&leaf_depth, &dist->leaf_depth);
+    hist_begin(&subtree_size, &dist->subtree_size);
+
+    /* ǳֻջϵ֡ת */
+    DistFrame local[128];
+    DistFrame* stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+
+    stack[sp].node = NULL;   /* ײ֡亢Ϊֵ */
+    stack[sp].cur = root;
+    stack[sp].size = 0;
+    stack[sp].degree = 0;
+    sp++;
+
+    while (sp > 0)
+    {
+        DistFrame* f = &stack[sp - 1];
+        if (f->cur)
+        {
+            const TreeNode* c = f->cur;
+            f->cur = c->next_sibling;
+            f->degree++;
+
+            if (sp >= cap)
+            {
+                DistFrame* ns = (DistFrame*)tree_traverse_grow(stack, local, &cap, sizeof(DistFrame), sp);
+                if (!ns)
+                {
+                    if (stack != local)
+                    {
+                        tree_mem_free(stack);
+                    }
+                    return -1;
+                }
+                stack = ns;
+            }
+
+            stack[sp].node = c;
+            stack[sp].cur = c->first_child;
+            stack[sp].size = 0;
+            stack[sp].degree = 0;
+            sp++;
+            continue;
+        }
+
+        sp--;
+        if (!f->node)
+        {
+            break;
+        }
+
+        /* ڵĺȫɣʱ sp ڵȣΪ 1 */
+        size_t size = 1 + f->size;
+        hist_add(&degree, f->degree);
+        hist_add(&subtree_size, size);
+        if (f->degree == 0)
+        {
+            hist_add(&leaf_depth, sp);
+        }
+        stack[sp - 1].size += size;
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free(stack);
+    }
+
+    hist_end(&degree);
+    hist_end(&leaf_depth);
+    hist_end(&subtree_size);
+    return 0;
+}
+
+/* ---------------- top-k ---------------- */
+
+typedef struct TopEntry
+{
+    const TreeNode* node;
+    size_t value;
+    size_t seq;               /* ţȡֵͬʱС߸ */
+    const TreeNode** path;    /* Ҷ */
+} TopEntry;
+
+/* Сѣitems[0] ǵǰ k һ */
+typedef struct TopHeap
+{
+    TopEntry* items;
+    size_t count;
+    size_t k;
+} TopHeap;
+
+/* ÿһջ֡ DistFrame ¼ڵ */
+typedef struct TopFrame
+{
+    const TreeNode* node;
+    const TreeNode* cur;
+    size_t size;
+    size_t degree;
+    size_t seq;
+} TopFrame;
+
+/* a Ƿ b  */
+static int top_worse(const TopEntry* a, const TopEntry* b)
+{
+    return a->value < b->value || (a->value == b->value && a->seq > b->seq);
+}
+
+static int top_accepts(const TopHeap* h, size_t value, size_t seq)
+{
+    if (h->count < h->k)
+    {
+        return 1;
+    }
+    if (h->k == 0)
+    {
+        return 0;
+    }
+
+    TopEntry probe;
+    probe.value = value;
+    probe.seq = seq;
+    return top_worse(&h->items[0], &probe);
+}
+
+static void top_sift_up(TopHeap* h, size_t i)
+{
+    TopEntry e = h->items[i];
+    while (i > 0)
+    {
+        size_t parent = (i - 1) / 2;
+        if (!top_worse(&e, &h->items[parent]))
+        {
+            break;
+        }
+        h->items[i] = h->items[parent];
+        i = parent;
+    }
+    h->items[i] = e;
+}
+
+static void top_sift_down(TopHeap* h, size_t i)
+{
+    TopEntry e = h->items[i];
+    for (;;)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= h->count)
+        {
+            break;
+        }
+        if (child + 1 < h->count && top_worse(&h->items[child + 1], &h->items[child]))
+        {
+            child++;
+        }
+        if (!top_worse(&h->items[child], &e))
+        {
+            break;
+        }
+        h->items[i] = h->items[child];
+        i = child;
+    }
+    h->items[i] = e;
+}
+
+/* һǰ top_accepts ȷϣʱ滻һ */
+static void top_push(TopHeap* h, const TopEntry* e)
+{
+    if (h->count < h->k)
+    {
+        h->items[h->count] = *e;
+        top_sift_up(h, h->count);
+        h->count++;
+    }
+    else
+    {
+        h->items[0] = *e;
+        top_sift_down(h, 0);
+    }
+}
+
+static int top_compare(const void* a, const void* b)
+{
+    const TopEntry* x = (const TopEntry*)a;
+    const TopEntry* y = (const TopEntry*)b;
+    if (x->value != y->value)
+    {
+        return (x->value > y->value) ? -1 : 1;
+    }
+    return (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static int top_init(TopHeap* h, size_t k)
+{
+    /*  int  */
+    if (k > (size_t)INT_MAX)
+    {
+        k = (size_t)INT_MAX;
+    }
+
+    h->count = 0;
+    h->k = k;
+    h->items = NULL;
+    if (k > 0)
+    {
+        h->items = (TopEntry*)tree_mem_alloc(sizeof(TopEntry) * k);
+        if (!h->items)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void top_release(TopHeap* h)
+{
+    for (size_t i = 0; i < h->count; ++i)
+    {
+        tree_mem_free((void*)h->items[i].path);
+    }
+    tree_mem_free(h->items);
+}
+
+/*
+ * һκķǵݹڵĺȫʱ֪ĶȺС
+ * Ϊ NULL Ĳ룻Ҷʱջ֡·
+ */
+static int top_walk(const TreeNode* root, TopHeap* leaves, TopHeap* degree, TopHeap* subtree)
+{
+    TopFrame local[128];
+    TopFrame* stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+    size_t seq = 0;
+    int rc = 0;
+
+    stack[sp].node = NULL;   /* ײ֡亢Ϊֵ */
+    stack[sp].cur = root;
+    stack[sp].size = 0;
+    stack[sp].degree = 0;
+    stack[sp].seq = 0;
+    sp++;
+
+    while (sp > 0)
+    {
+        TopFrame* f = &stack[sp - 1];
+        if (f->cur)
+        {
+            const TreeNode* c = f->cur;
+            f->cur = c->next_sibling;
+            f->degree++;
+
+            if (sp >= cap)
+            {
+                TopFrame* ns = (TopFrame*)tree_traverse_grow(stack, local, &cap, sizeof(TopFrame), sp);
+                if (!ns)
+                {
+                    rc = -1;
+                    break;
+                }
+                stack = ns;
+            }
+
+            stack[sp].node = c;
+            stack[sp].cur = c->first_child;
+            stack[sp].size = 0;
+            stack[sp].degree = 0;
+            stack[sp].seq = seq++;
+            sp++;
+            continue;
+        }
+
+        sp--;
+        if (!f->node)
+        {
+            break;
+        }
+
+        /* ʱ sp ڵȣΪ 1stack[1..sp] ǴӸýڵ· */
+        size_t size = 1 + f->size;
+        if (leaves && f->degree == 0 && top_accepts(leaves, sp, f->seq))
+        {
+            /* ʱñһ· */
+            const TreeNode** buf = (leaves->count == leaves->k) ? leaves->items[0].path : NULL;
+            buf = (const TreeNode**)tree_mem_realloc((void*)buf, sizeof(const TreeNode*) * sp);
+            if (!buf)
+            {
+                rc = -1;
+                break;
+            }
+            if (leaves->count == leaves->k)
+            {
+                leaves->items[0].path = NULL;
+            }
+            for (size_t i = 0; i < sp; ++i)
+            {
+                buf[i] = stack[i + 1].node;
+            }
+
+            TopEntry e;
+            e.node = f->node;
+            e.value = sp;
+            e.seq = f->seq;
+            e.path = buf;
+            top_push(leaves, &e);
+        }
+        if (degree && top_accepts(degree, f->degree, f->seq))
+        {
+            TopEntry e;
+            e.node = f->node;
+            e.value = f->degree;
+            e.seq = f->seq;
+            e.path = NULL;
+            top_push(degree, &e);
+        }
+        if (subtree && top_accepts(subtree, size, f->seq))
+        {
+            TopEntry e;
+            e.node = f->node;
+            e.value = size;
+            e.seq = f->seq;
+            e.path = NULL;
+            top_push(subtree, &e);
+        }
+        stack[sp - 1].size += size;
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free(stack);
+    }
+    return rc;
+}
+
+/* ȻСȡ top-k */
+static int top_ranked(const TreeNode* root, size_t k, TreeRankedNode* out, int by_size)
+{
+    TopHeap h;
+    if ((k > 0 && !out) || top_init(&h, k) != 0)
+    {
+        return -1;
+    }
+
+    if (top_walk(root, NULL, by_size ? NULL : &h, by_size ? &h : NULL) != 0)
+    {
+        top_release(&h);
+        return -1;
+    }
+
+    if (h.count > 1)
+    {
+        qsort(h.items, h.count, sizeof(TopEntry), top_compare);
+    }
+    for (size_t i = 0; i < h.count; ++i)
+    {
+        out[i].node = h.items[i].node;
+        out[i].value = h.items[i].value;
+    }
+
+    int found = (int)h.count;
+    tree_mem_free(h.items);
+    return found;
+}
+
+int tree_top_degree(const TreeNode* root, size_t k, TreeRankedNode* out)
+{
+    return top_ranked(root, k, out, 0);
+}
+
+int tree_top_subtrees(const TreeNode* root, size_t k, TreeRankedNode* out)
+{
+    return top_ranked(root, k, out, 1);
+}
+
+int tree_top_deepest_leaves(const TreeNode* root, size_t k, TreeLeafPath* out)
+{
+    TopHeap h;
+    if ((k > 0 && !out) || top_init(&h, k) != 0)
+    {
+        return -1;
+    }
+
+    if (top_walk(root, &h, NULL, NULL) != 0)
+    {
+        top_release(&h);
+        return -1;
+    }
+
+    /* ·Ȩת */
+    if (h.count > 1)
+    {
+        qsort(h.items, h.count, sizeof(TopEntry), top_compare);
+    }
+    for (size_t i = 0; i < h.count; ++i)
+    {
+        out[i].leaf = h.items[i].node;
+        out[i].depth = h.items[i].value;
+        out[i].path = h.items[i].path;
+    }
+
+    int found = (int)h.count;
+    tree_mem_free(h.items);
+    return found;
+}
+
+void tree_leaf_paths_free(TreeLeafPath* leaves, size_t count)
+{
+    if (!leaves)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        tree_mem_free((void*)leaves[i].path);
+        leaves[i].path = NULL;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef TREE_ANALYTICS_H
+#define TREE_ANALYTICS_H
+
+#include <stddef.h>
+#include "tree.h"
+
+/*
+ * ֱͼbins  bin_count ɵṩbins Ϊ NULLbin_count Ϊ 0ʱֻͳƾֵֵ
+ * bins[i] ΪȡֵǡΪ i һͬʱۼ >= bin_count-1 ֵ
+ * ֶͳƺд
+ */
+typedef struct TreeHistogram
+{
+    size_t* bins;
+    size_t bin_count;
+
+    size_t samples;   /*  */
+    size_t max;       /* ȷֵ */
+    double mean;      /* ȷƽֵ */
+    size_t p50;       /* λֱͼ㣻һʱΪø½ */
+    size_t p90;
+    size_t p99;
+} TreeHistogram;
+
+/* һαõֲַ */
+typedef struct TreeDistribution
+{
+    TreeHistogram degree;         /* ÿڵĶȣΪȫڵ */
+    TreeHistogram leaf_depth;     /* ÿҶӵȣΪ 1 tree_depth һ£ */
+    TreeHistogram subtree_size;   /* ÿڵڵ */
+} TreeDistribution;
+
+/*
+ *  rootֵܣһηǵݹд dist ֱͼ
+ * ǰúøֱͼ bins / bin_countȰ bins 㡣
+ * ڵڴ棬ʱչջɹ 0ڴ治㷵 -1
+ */
+int tree_distribution(const TreeNode* root, TreeDistribution* dist);
+
+/* ֱͼλ p0~1ۼ״δﵽ p * samples ȡֵ */
+size_t tree_histogram_percentile(const TreeHistogram* hist, double p);
+
+/* top-k ڵ㼰ȡֵȻС */
+typedef struct TreeRankedNode
+{
+    const TreeNode* node;
+    size_t value;
+} TreeRankedNode;
+
+/* ҶӼĸҶӵ· */
+typedef struct TreeLeafPath
+{
+    const TreeNode* leaf;
+    size_t depth;            /* Ϊ 1 */
+    const TreeNode** path;   /* path[0] Ϊpath[depth - 1] ΪҶӣ tree_leaf_paths_free ͷ */
+} TreeLeafPath;
+
+/*
+ * top-k ѯһηǵݹôСΪ k Сѱǰõ k 
+ * ȡֵӴСд outṩ k Ԫأȡֵͬʱǰȡ
+ * ֻ O(k) ĶѺ߳ȵıջҶ·ռ O(k * )
+ * дĸ kڴ治㷵 -1
+ */
+int tree_top_deepest_leaves(const TreeNode* root, size_t k, TreeLeafPath* out);
+int tree_top_degree(const TreeNode* root, size_t k, TreeRankedNode* out);
+int tree_top_subtrees(const TreeNode* root, size_t k, TreeRankedNode* out);
+
+/* ͷ tree_top_deepest_leaves д count · */
+void tree_leaf_paths_free(TreeLeafPath* leaves, size_t count);
+
+#endif /* TREE_ANALYTICS_H */
@@ -0,0 +1,215 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tree_async.h"
+#include "tree_internal.h"
+#include "tree_thread.h"
+
+struct TreeLoadHandle
+{
+    char* filename;
+    tree_thread_t thread;
+
+    tree_mutex_t lock;
+    tree_cond_t done_cond;
+    TreeLoadStatus status;     /*  lock  */
+    TreeNode* result;          /*  lock  */
+
+    /* ȡ־ɼ߳߳ͬʱ */
+    tree_atomic_t bytes_done;
+    tree_atomic_t bytes_total;
+    tree_atomic_t nodes_done;
+    tree_atomic_t nodes_total;
+    tree_atomic_t cancel;
+};
+
+/* ȡļСʧܷ 0 λļͷ */
+static size_t file_size(FILE* fp)
+{
+    long long size = 0;
+#ifdef _WIN32
+    if (_fseeki64(fp, 0, SEEK_END) == 0)
+    {
+        size = _ftelli64(fp);
+    }
+    _fseeki64(fp, 0, SEEK_SET);
+#else
+    if (fseeko(fp, 0, SEEK_END) == 0)
+    {
+        size = (long long)ftello(fp);
+    }
+    fseeko(fp, 0, SEEK_SET);
+#endif
+    return (size > 0) ? (size_t)size : 0;
+}
+
+static int async_on_progress(void* ctx, size_t bytes, size_t nodes, size_t total)
+{
+    TreeLoadHandle* h = (TreeLoadHandle*)ctx;
+    tree_atomic_store(&h->bytes_done, (long long)bytes);
+    tree_atomic_store(&h->nodes_done, (long long)nodes);
+    tree_atomic_store(&h->nodes_total, (long long)total);
+    return tree_atomic_load(&h->cancel) != 0;
+}
+
+static TREE_THREAD_PROC(async_load_main, arg)
+{
+    TreeLoadHandle* h = (TreeLoadHandle*)arg;
+    TreeNode* root = NULL;
+
+    FILE* fp = fopen(h->filename, "r");
+    if (fp)
+    {
+        tree_atomic_store(&h->bytes_total, (long long)file_size(fp));
+
+        TreeLoadMonitor monitor;
+        monitor.on_progress = async_on_progress;
+        monitor.ctx = h;
+        root = tree_build_from_fp(fp, &monitor);
+        fclose(fp);
+    }
+
+    /* һɺյȡͬЧ */
+    int cancelled = tree_atomic_load(&h->cancel) != 0;
+    if (cancelled && root)
+    {
+        tree_free(root);
+        root = NULL;
+    }
+
+    tree_mutex_lock(&h->lock);
+    h->result = root;
+    h->status = root ? TREE_LOAD_DONE : (cancelled ? TREE_LOAD_CANCELLED : TREE_LOAD_FAILED);
+    tree_cond_broadcast(&h->done_cond);
+    tree_mutex_unlock(&h->lock);
+
+    TREE_THREAD_RETURN;
+}
+
+TreeLoadHandle* tree_load_async(const char* filename)
+{
+    if (!filename)
+    {
+        return NULL;
+    }
+
+    TreeLoadHandle* h = (TreeLoadHandle*)tree_mem_calloc(1, sizeof(TreeLoadHandle));
+    if (!h)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(filename) + 1;
+    h->filename = (char*)tree_mem_alloc(len);
+    if (!h->filename)
+    {
+        tree_mem_free(h);
+        return NULL;
+    }
+    memcpy(h->filename, filename, len);
+
+    h->status = TREE_LOAD_RUNNING;
+    tree_mutex_init(&h->lock);
+    tree_cond_init(&h->done_cond);
+
+    if (tree_thread_start(&h->thread, async_load_main, h) != 0)
+    {
+        tree_cond_destroy(&h->done_cond);
+        tree_mutex_destroy(&h->lock);
+        tree_mem_free(h->filename);
+        tree_mem_free(h);
+        return NULL;
+    }
+
+    return h;
+}
+
+void tree_load_progress(const TreeLoadHandle* handle, TreeLoadProgress* out)
+{
+    if (!out)
+    {
+        return;
+    }
+
+    memset(out, 0, sizeof(*out));
+    if (!handle)
+    {
+        return;
+    }
+
+    /* ԭӶȡ޸Ķȥ const ֻΪװĲ */
+    TreeLoadHandle* h = (TreeLoadHandle*)handle;
+    out->bytes_done = (size_t)tree_atomic_load(&h->bytes_done);
+    out->bytes_total = (size_t)tree_atomic_load(&h->bytes_total);
+    out->nodes_done = (size_t)tree_atomic_load(&h->nodes_done);
+    out->nodes_total = (size_t)tree_atomic_load(&h->nodes_total);
+}
+
+void tree_load_cancel(TreeLoadHandle* handle)
+{
+    if (handle)
+    {
+        tree_atomic_store(&handle->cancel, 1);
+    }
+}
+
+TreeLoadStatus tree_load_poll(TreeLoadHandle* handle)
+{
+    return tree_load_wait(handle, 0);
+}
+
+TreeLoadStatus tree_load_wait(TreeLoadHandle* handle, long timeout_ms)
+{
+    if (!handle)
+    {
+        return TREE_LOAD_FAILED;
+    }
+
+    tree_mutex_lock(&handle->lock);
+    if (timeout_ms < 0)
+    {
+        while (handle->status == TREE_LOAD_RUNNING)
+        {
+            tree_cond_wait(&handle->done_cond, &handle->lock);
+        }
+    }
+    else if (timeout_ms > 0 && handle->status == TREE_LOAD_RUNNING)
+    {
+        /* ֻȴһΣٻʱǰ RUNNING߿ɼѯ */
+        tree_cond_timedwait(&handle->done_cond, &handle->lock, (unsigned long)timeout_ms);
+    }
+    TreeLoadStatus status = handle->status;
+    tree_mutex_unlock(&handle->lock);
+    return status;
+}
+
+TreeNode* tree_load_finish(TreeLoadHandle* handle, TreeLoadStatus* status)
+{
+    if (!handle)
+    {
+        if (status)
+        {
+            *status = TREE_LOAD_FAILED;
+        }
+        return NULL;
+    }
+
+    TreeLoadStatus st = tree_load_wait(handle, -1);
+    tree_thread_join(handle->thread);
+
+    TreeNode* root = handle->result;
+    tree_cond_destroy(&handle->done_cond);
+    tree_mutex_destroy(&handle->lock);
+    tree_mem_free(handle->filename);
+    tree_mem_free(handle);
+
+    if (status)
+    {
+        *status = st;
+    }
+    return root;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef TREE_ASYNC_H
+#define TREE_ASYNC_H
+
+#include <stddef.h>
+#include "tree.h"
+
+/* ̨״̬ */
+typedef enum TreeLoadStatus
+{
+    TREE_LOAD_RUNNING,     /* ڼ */
+    TREE_LOAD_DONE,        /* سɹ */
+    TREE_LOAD_FAILED,      /* 򿪻ʧ */
+    TREE_LOAD_CANCELLED    /* ѱȡ */
+} TreeLoadStatus;
+
+/* ؽȣδ֪ʱӦֶΪ 0 */
+typedef struct TreeLoadProgress
+{
+    size_t bytes_done;
+    size_t bytes_total;    /* ļС */
+    size_t nodes_done;
+    size_t nodes_total;    /* ļĽڵ */
+} TreeLoadProgress;
+
+typedef struct TreeLoadHandle TreeLoadHandle;
+
+/* ںִ̨߳ buildTreeFromFile(filename)ؾʧܷ NULL */
+TreeLoadHandle* tree_load_async(const char* filename);
+
+/* ȡǰȣ߳ʱ */
+void tree_load_progress(const TreeLoadHandle* handle, TreeLoadProgress* out);
+
+/* ȡ̻߳һڵ㴦ֹͣͷѴĽڵ */
+void tree_load_cancel(TreeLoadHandle* handle);
+
+/* زѯ״̬ */
+TreeLoadStatus tree_load_poll(TreeLoadHandle* handle);
+
+/* ȴ timeout_ms 루ʾһֱȴشʱ״̬ */
+TreeLoadStatus tree_load_wait(TreeLoadHandle* handle, long timeout_ms);
+
+/*
+ * ȴؽȡ߽ͷž
+ * ɹظڵ㣨ɵ tree_freeʧܻȡ NULLstatus Ϊ NULL
+ */
+TreeNode* tree_load_finish(TreeLoadHandle* handle, TreeLoadStatus* status);
+
+#endif /* TREE_ASYNC_H */
@@ -0,0 +1,1001 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tree_diff.h"
+#include "tree_hash.h"
+#include "tree_traverse.h"
+
+#define DIFF_NONE ((size_t)-1)
+
+static int str_equal(const char* a, const char* b)
+{
+    if (!a || !b)
+    {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static uint64_t label_hash(const char* s)
+{
+    uint64_t h = 0xCBF29CE484222325ULL;
+    if (!s)
+    {
+        return 0;
+    }
+    while (*s)
+    {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+static uint64_t ptr_hash(const void* p)
+{
+    uint64_t x = (uint64_t)(uintptr_t)p;
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static size_t table_cap_for(size_t n)
+{
+    size_t cap = 16;
+    while (cap < n * 2)
+    {
+        cap *= 2;
+    }
+    return cap;
+}
+
+static int script_push(TreeEditScript* s, const TreeEdit* e)
+{
+    if (s->count >= s->cap)
+    {
+        size_t newcap = (s->cap == 0) ? 64 : (s->cap * 2);
+        TreeEdit* ne = (TreeEdit*)tree_mem_realloc(s->edits, sizeof(TreeEdit) * newcap);
+        if (!ne)
+        {
+            return 0;
+        }
+        s->edits = ne;
+        s->cap = newcap;
+    }
+    s->edits[s->count++] = *e;
+    return 1;
+}
+
+/* ----------------  -> ± ---------------- */
+
+/*
+ * Ŷַÿͬļһۣ next[] иü±꣨ԭ˳򣩡
+ * ΪϣڵݣȡʱǴͷ̯ O(1)
+ */
+typedef struct DiffSlot
+{
+    int used;
+    uint64_t h;
+    size_t size;          /* ϣʱΪС */
+    const char* label;    /* ݷʱΪڵ */
+    size_t head;
+} DiffSlot;
+
+typedef struct DiffBuckets
+{
+    DiffSlot* slots;
+    size_t cap;
+    size_t* next;
+} DiffBuckets;
+
+static int buckets_init(DiffBuckets* b, size_t n)
+{
+    b->cap = table_cap_for(n);
+    b->slots = (DiffSlot*)tree_mem_calloc(b->cap, sizeof(DiffSlot));
+    b->next = (size_t*)tree_mem_alloc(sizeof(size_t) * (n ? n : 1));
+    if (!b->slots || !b->next)
+    {
+        tree_mem_free(b->slots);
+        tree_mem_free(b->next);
+        return 0;
+    }
+    return 1;
+}
+
+static void buckets_free(DiffBuckets* b)
+{
+    tree_mem_free(b->slots);
+    tree_mem_free(b->next);
+}
+
+/* by_label Ϊ 0 ʱ (h, size) ƥ䣬 label ƥ */
+static DiffSlot* buckets_slot(DiffBuckets* b, int by_label, uint64_t h, size_t size, const char* label, int create)
+{
+    size_t s = (size_t)(h & (uint64_t)(b->cap - 1));
+    while (b->slots[s].used)
+    {
+        DiffSlot* slot = &b->slots[s];
+        if (slot->h == h && (by_label ? str_equal(slot->label, label) : slot->size == size))
+        {
+            return slot;
+        }
+        s = (s + 1) & (b->cap - 1);
+    }
+
+    if (!create)
+    {
+        return NULL;
+    }
+
+    DiffSlot* slot = &b->slots[s];
+    slot->used = 1;
+    slot->h = h;
+    slot->size = size;
+    slot->label = label;
+    slot->head = DIFF_NONE;
+    return slot;
+}
+
+/* ----------------  ---------------- */
+
+typedef struct DiffPair
+{
+    TreeNode* old_node;
+    const TreeNode* new_node;
+} DiffPair;
+
+typedef struct DiffCtx
+{
+    TreeNode* old_root;
+    const TreeNode* new_root;
+    TreeHashIndex* old_idx;
+    TreeHashIndex* new_idx;
+
+    TreeEditScript* script;     /* ֻ RELABEL */
+    TreeEditScript dels;        /* ѡɾ */
+    TreeHash* del_hash;
+    TreeEditScript places;      /* ƶڵ顢λõ */
+    TreeHash* place_hash;
+
+    DiffPair* queue;            /* ȽϺƥڵ */
+    size_t qhead;
+    size_t qcount;
+    size_t qcap;
+
+    /* ÿԽڵ㸴õʱ */
+    size_t scratch_cap;
+    TreeNode** olds;
+    const TreeNode** news;
+    TreeHash* ohash;
+    TreeHash* nhash;
+    size_t* omatch;
+    size_t* nmatch;
+    size_t* seq;
+    size_t* tails;
+    size_t* prev;
+    unsigned char* keep;
+} DiffCtx;
+
+static int ctx_reserve(DiffCtx* ctx, size_t n)
+{
+    if (n <= ctx->scratch_cap)
+    {
+        return 1;
+    }
+
+    size_t cap = ctx->scratch_cap ? ctx->scratch_cap : 64;
+    while (cap < n)
+    {
+        cap *= 2;
+    }
+
+#define DIFF_GROW(field, type) \
+    do { type* p = (type*)tree_mem_realloc((void*)ctx->field, sizeof(type) * cap); if (!p) return 0; ctx->field = p; } while (0)
+
+    DIFF_GROW(olds, TreeNode*);
+    DIFF_GROW(news, const TreeNode*);
+    DIFF_GROW(ohash, TreeHash);
+    DIFF_GROW(nhash, TreeHash);
+    DIFF_GROW(omatch, size_t);
+    DIFF_GROW(nmatch, size_t);
+    DIFF_GROW(seq, size_t);
+    DIFF_GROW(tails, size_t);
+    DIFF_GROW(prev, size_t);
+    DIFF_GROW(keep, unsigned char);
+
+#undef DIFF_GROW
+
+    ctx->scratch_cap = cap;
+    return 1;
+}
+
+static int queue_push(DiffCtx* ctx, TreeNode* o, const TreeNode* n)
+{
+    if (ctx->qcount >= ctx->qcap)
+    {
+        size_t newcap = (ctx->qcap == 0) ? 64 : (ctx->qcap * 2);
+        DiffPair* nq = (DiffPair*)tree_mem_realloc(ctx->queue, sizeof(DiffPair) * newcap);
+        if (!nq)
+        {
+            return 0;
+        }
+        ctx->queue = nq;
+        ctx->qcap = newcap;
+    }
+    ctx->queue[ctx->qcount].old_node = o;
+    ctx->queue[ctx->qcount].new_node = n;
+    ctx->qcount++;
+    return 1;
+}
+
+/* ¼һϣĺѡ༭ɾ/ƶ */
+static int cand_push(TreeEditScript* list, TreeHash** phashes, const TreeEdit* e, TreeHash h)
+{
+    size_t oldcap = list->cap;
+    if (!script_push(list, e))
+    {
+        return 0;
+    }
+    if (list->cap != oldcap)
+    {
+        TreeHash* nh = (TreeHash*)tree_mem_realloc(*phashes, sizeof(TreeHash) * list->cap);
+        if (!nh)
+        {
+            list->count--;
+            return 0;
+        }
+        *phashes = nh;
+    }
+    (*phashes)[list->count - 1] = h;
+    return 1;
+}
+
+/*
+ *  seq[0..m) ϸУkeep[k] ǱԪء
+ * ĺ˳򲻱䣬ƥ亢Ҫ MOVE
+ */
+static void mark_lis(DiffCtx* ctx, size_t m)
+{
+    size_t len = 0;
+    for (size_t k = 0; k < m; ++k)
+    {
+        size_t lo = 0;
+        size_t hi = len;
+        while (lo < hi)
+        {
+            size_t mid = (lo + hi) / 2;
+            if (ctx->seq[ctx->tails[mid]] < ctx->seq[k])
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        ctx->prev[k] = (lo > 0) ? ctx->tails[lo - 1] : DIFF_NONE;
+        ctx->tails[lo] = k;
+        if (lo == len)
+        {
+            len++;
+        }
+        ctx->keep[k] = 0;
+    }
+
+    size_t k = (len > 0) ? ctx->tails[len - 1] : DIFF_NONE;
+    while (k != DIFF_NONE)
+    {
+        ctx->keep[k] = 1;
+        k = ctx->prev[k];
+    }
+}
+
+/*
+ * Ƚһƥڵĺop/np Ϊ NULL ʾ㣩
+ * ƥ˳ϣȫͬ -> ͬ -> ʣİ˳Сͬ
+ */
+static int diff_children(DiffCtx* ctx, TreeNode* op, const TreeNode* np)
+{
+    TreeNode* old_first = op ? op->first_child : ctx->old_root;
+    const TreeNode* new_first = np ? np->first_child : ctx->new_root;
+
+    size_t no = 0;
+    size_t nn = 0;
+    for (const TreeNode* p = old_first; p; p = p->next_sibling)
+    {
+        no++;
+    }
+    for (const TreeNode* p = new_first; p; p = p->next_sibling)
+    {
+        nn++;
+    }
+
+    if (!ctx_reserve(ctx, (no > nn) ? no : nn))
+    {
+        return 0;
+    }
+
+    size_t i = 0;
+    for (TreeNode* p = old_first; p; p = p->next_sibling, ++i)
+    {
+        ctx->olds[i] = p;
+        tree_hash_index_get(ctx->old_idx, p, &ctx->ohash[i]);
+        ctx->omatch[i] = DIFF_NONE;
+    }
+    size_t j = 0;
+    for (const TreeNode* p = new_first; p; p = p->next_sibling, ++j)
+    {
+        ctx->news[j] = p;
+        tree_hash_index_get(ctx->new_idx, p, &ctx->nhash[j]);
+        ctx->nmatch[j] = DIFF_NONE;
+    }
+
+    if (no > 0 && nn > 0)
+    {
+        DiffBuckets by_hash;
+        DiffBuckets by_label;
+        if (!buckets_init(&by_hash, no))
+        {
+            return 0;
+        }
+        if (!buckets_init(&by_label, no))
+        {
+            buckets_free(&by_hash);
+            return 0;
+        }
+
+        /* 룬ʹͷΪǰ± */
+        for (i = no; i-- > 0;)
+        {
+            DiffSlot* s = buckets_slot(&by_hash, 0, ctx->ohash[i].value, ctx->ohash[i].size, NULL, 1);
+            by_hash.next[i] = s->head;
+            s->head = i;
+
+            const char* label = ctx->olds[i]->data;
+            s = buckets_slot(&by_label, 1, label_hash(label), 0, label, 1);
+            by_label.next[i] = s->head;
+            s->head = i;
+        }
+
+        /* 1. ȫͬ */
+        for (j = 0; j < nn; ++j)
+        {
+            DiffSlot* s = buckets_slot(&by_hash, 0, ctx->nhash[j].value, ctx->nhash[j].size, NULL, 0);
+            if (s && s->head != DIFF_NONE)
+            {
+                i = s->head;
+                s->head = by_hash.next[i];
+                ctx->omatch[i] = j;
+                ctx->nmatch[j] = i;
+            }
+        }
+
+        /* 2. ͬĽڵ㣬Ƚ亢 */
+        for (j = 0; j < nn; ++j)
+        {
+            if (ctx->nmatch[j] != DIFF_NONE)
+            {
+                continue;
+            }
+
+            const char* label = ctx->news[j]->data;
+            DiffSlot* s = buckets_slot(&by_label, 1, label_hash(label), 0, label, 0);
+            if (!s)
+            {
+                continue;
+            }
+            while (s->head != DIFF_NONE && ctx->omatch[s->head] != DIFF_NONE)
+            {
+                s->head = by_label.next[s->head];
+            }
+            if (s->head != DIFF_NONE)
+            {
+                i = s->head;
+                s->head = by_label.next[i];
+                ctx->omatch[i] = j;
+                ctx->nmatch[j] = i;
+            }
+        }
+
+        buckets_free(&by_hash);
+        buckets_free(&by_label);
+
+        /* 3. ʣİ˳ԣСͬΪ */
+        i = 0;
+        j = 0;
+        while (i < no && j < nn)
+        {
+            if (ctx->omatch[i] != DIFF_NONE)
+            {
+                i++;
+                continue;
+            }
+            if (ctx->nmatch[j] != DIFF_NONE)
+            {
+                j++;
+                continue;
+            }
+            if (ctx->ohash[i].size == ctx->nhash[j].size)
+            {
+                ctx->omatch[i] = j;
+                ctx->nmatch[j] = i;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    /* ƥĽڵ㣺롢ȷЩҪƶ */
+    size_t m = 0;
+    for (j = 0; j < nn; ++j)
+    {
+        i = ctx->nmatch[j];
+        if (i == DIFF_NONE)
+        {
+            continue;
+        }
+
+        if (!str_equal(ctx->olds[i]->data, ctx->news[j]->data))
+        {
+            TreeEdit e = { TREE_EDIT_RELABEL, ctx->olds[i], ctx->news[j], NULL, NULL, 0 };
+            if (!script_push(ctx->script, &e))
+            {
+                return 0;
+            }
+        }
+
+        if (!tree_hash_same(ctx->ohash[i], ctx->nhash[j]))
+        {
+            if (!queue_push(ctx, ctx->olds[i], ctx->news[j]))
+            {
+                return 0;
+            }
+        }
+
+        ctx->seq[m++] = i;
+    }
+    mark_lis(ctx, m);
+
+    m = 0;
+    for (j = 0; j < nn; ++j)
+    {
+        i = ctx->nmatch[j];
+        if (i == DIFF_NONE)
+        {
+            TreeEdit e = { TREE_EDIT_INSERT, NULL, ctx->news[j], NULL, op, j };
+            if (!cand_push(&ctx->places, &ctx->place_hash, &e, ctx->nhash[j]))
+            {
+                return 0;
+            }
+        }
+        else if (!ctx->keep[m++])
+        {
+            TreeEdit e = { TREE_EDIT_MOVE, ctx->olds[i], NULL, op, op, j };
+            if (!cand_push(&ctx->places, &ctx->place_hash, &e, ctx->nhash[j]))
+            {
+                return 0;
+            }
+        }
+    }
+
+    for (i = 0; i < no; ++i)
+    {
+        if (ctx->omatch[i] == DIFF_NONE)
+        {
+            TreeEdit e = { TREE_EDIT_DELETE, ctx->olds[i], NULL, op, NULL, 0 };
+            if (!cand_push(&ctx->dels, &ctx->del_hash, &e, ctx->ohash[i]))
+            {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/* ɾĳȫͬΪ縸ڵƶ */
+static int diff_pair_moves(DiffCtx* ctx, unsigned char* consumed)
+{
+    if (ctx->dels.count == 0)
+    {
+        return 1;
+    }
+
+    DiffBuckets b;
+    if (!buckets_init(&b, ctx->dels.count))
+    {
+        return 0;
+    }
+
+    for (size_t d = ctx->dels.count; d-- > 0;)
+    {
+        DiffSlot* s = buckets_slot(&b, 0, ctx->del_hash[d].value, ctx->del_hash[d].size, NULL, 1);
+        b.next[d] = s->head;
+        s->head = d;
+    }
+
+    for (size_t k = 0; k < ctx->places.count; ++k)
+    {
+        TreeEdit* e = &ctx->places.edits[k];
+        if (e->type != TREE_EDIT_INSERT)
+        {
+            continue;
+        }
+
+        DiffSlot* s = buckets_slot(&b, 0, ctx->place_hash[k].value, ctx->place_hash[k].size, NULL, 0);
+        if (s && s->head != DIFF_NONE)
+        {
+            size_t d = s->head;
+            s->head = b.next[d];
+            consumed[d] = 1;
+            e->type = TREE_EDIT_MOVE;
+            e->node = ctx->dels.edits[d].node;
+            e->old_parent = ctx->dels.edits[d].old_parent;
+            e->source = NULL;
+        }
+    }
+
+    buckets_free(&b);
+    return 1;
+}
+
+static void diff_ctx_release(DiffCtx* ctx)
+{
+    tree_hash_index_free(ctx->old_idx);
+    tree_hash_index_free(ctx->new_idx);
+    tree_mem_free(ctx->dels.edits);
+    tree_mem_free(ctx->del_hash);
+    tree_mem_free(ctx->places.edits);
+    tree_mem_free(ctx->place_hash);
+    tree_mem_free(ctx->queue);
+    tree_mem_free((void*)ctx->olds);
+    tree_mem_free((void*)ctx->news);
+    tree_mem_free(ctx->ohash);
+    tree_mem_free(ctx->nhash);
+    tree_mem_free(ctx->omatch);
+    tree_mem_free(ctx->nmatch);
+    tree_mem_free(ctx->seq);
+    tree_mem_free(ctx->tails);
+    tree_mem_free(ctx->prev);
+    tree_mem_free(ctx->keep);
+}
+
+TreeEditScript* tree_diff(TreeNode* old_root, const TreeNode* new_root)
+{
+    DiffCtx ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.old_root = old_root;
+    ctx.new_root = new_root;
+
+    ctx.script = (TreeEditScript*)tree_mem_calloc(1, sizeof(TreeEditScript));
+    ctx.old_idx = tree_hash_index_build(old_root);
+    ctx.new_idx = tree_hash_index_build(new_root);
+    int ok = ctx.script && ctx.old_idx && ctx.new_idx;
+
+    /* Ϊһ⸸ڵ */
+    if (ok)
+    {
+        ok = diff_children(&ctx, NULL, NULL);
+    }
+    while (ok && ctx.qhead < ctx.qcount)
+    {
+        DiffPair p = ctx.queue[ctx.qhead++];
+        ok = diff_children(&ctx, p.old_node, p.new_node);
+    }
+
+    unsigned char* consumed = NULL;
+    if (ok)
+    {
+        consumed = (unsigned char*)tree_mem_calloc(ctx.dels.count ? ctx.dels.count : 1, 1);
+        ok = consumed && diff_pair_moves(&ctx, consumed);
+    }
+
+    /*   -> ɾ -> /ƶ ˳ƴսű */
+    for (size_t d = 0; ok && d < ctx.dels.count; ++d)
+    {
+        if (!consumed[d])
+        {
+            ok = script_push(ctx.script, &ctx.dels.edits[d]);
+        }
+    }
+    for (size_t k = 0; ok && k < ctx.places.count; ++k)
+    {
+        ok = script_push(ctx.script, &ctx.places.edits[k]);
+    }
+
+    tree_mem_free(consumed);
+    diff_ctx_release(&ctx);
+
+    if (!ok)
+    {
+        tree_edit_script_free(ctx.script);
+        return NULL;
+    }
+    return ctx.script;
+}
+
+void tree_edit_script_free(TreeEditScript* script)
+{
+    if (!script)
+    {
+        return;
+    }
+
+    tree_mem_free(script->edits);
+    tree_mem_free(script);
+}
+
+/* ---------------- Ӧýű ---------------- */
+
+/* 򵥵ָ뼯ϣŶַ */
+typedef struct PtrSet
+{
+    const void** keys;
+    size_t cap;
+} PtrSet;
+
+static int ptrset_init(PtrSet* s, size_t n)
+{
+    s->cap = table_cap_for(n);
+    s->keys = (const void**)tree_mem_calloc(s->cap, sizeof(void*));
+    return s->keys != NULL;
+}
+
+/*  1 ʾ¼룬0 ʾѴ */
+static int ptrset_add(PtrSet* s, const void* p)
+{
+    size_t i = (size_t)(ptr_hash(p) & (uint64_t)(s->cap - 1));
+    while (s->keys[i])
+    {
+        if (s->keys[i] == p)
+        {
+            return 0;
+        }
+        i = (i + 1) & (s->cap - 1);
+    }
+    s->keys[i] = p;
+    return 1;
+}
+
+static int ptrset_has(const PtrSet* s, const void* p)
+{
+    size_t i = (size_t)(ptr_hash(p) & (uint64_t)(s->cap - 1));
+    while (s->keys[i])
+    {
+        if (s->keys[i] == p)
+        {
+            return 1;
+        }
+        i = (i + 1) & (s->cap - 1);
+    }
+    return 0;
+}
+
+static TreeNode** child_link(TreeNode** proot, TreeNode* parent)
+{
+    return parent ? &parent->first_child : proot;
+}
+
+/* ʱջ֡src ΪƵֵα꣬slot Ϊ丱Ӧҽӵλ */
+typedef struct CopyFrame
+{
+    const TreeNode* src;
+    TreeNode** slot;
+} CopyFrame;
+
+/* Ƶڵ㼰ֵܣڵ㣬ʽջȫ */
+static TreeNode* copy_subtree(const TreeNode* src)
+{
+    CopyFrame local[TREE_TRAVERSE_LOCAL];
+    CopyFrame* stack = local;
+    size_t cap = TREE_TRAVERSE_LOCAL;
+    size_t sp = 0;
+    TreeNode* result = NULL;
+    int ok = 1;
+
+    stack[sp].src = src;
+    stack[sp].slot = &result;
+    sp++;
+
+    while (sp > 0)
+    {
+        CopyFrame* f = &stack[sp - 1];
+        const TreeNode* n = f->src;
+        if (!n)
+        {
+            sp--;
+            continue;
+        }
+
+        /* ײֻ src ֵǰ */
+        f->src = (sp == 1) ? NULL : n->next_sibling;
+
+        TreeNode* copy = tree_create_node(n->data);
+        if (copy && n->data && !copy->data)
+        {
+            tree_mem_free(copy);
+            copy = NULL;
+        }
+        if (!copy)
+        {
+            ok = 0;
+            break;
+        }
+        *f->slot = copy;
+        f->slot = &copy->next_sibling;
+
+        if (n->first_child)
+        {
+            if (sp >= cap)
+            {
+                CopyFrame* ns = (CopyFrame*)tree_traverse_grow(stack, local, &cap, sizeof(*stack), sp);
+                if (!ns)
+                {
+                    ok = 0;
+                    break;
+                }
+                stack = ns;
+            }
+            stack[sp].src = n->first_child;
+            stack[sp].slot = &copy->first_child;
+            sp++;
+        }
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free(stack);
+    }
+    if (!ok)
+    {
+        /* ѴĽڵ㶼ѹҽ result £ */
+        tree_free(result);
+        return NULL;
+    }
+    return result;
+}
+
+/*
+ * Ӧǰһ׼õڴ棺õݡĸժõϡ
+ * ȫ׼ɹſʼ޸ڴ治ʱԭ
+ */
+typedef struct ApplyPrep
+{
+    char** labels;        /* ÿ RELABEL ݣű˳ */
+    size_t nlabels;       /* ׼ĸ */
+    TreeNode** copies;    /* ÿ INSERT ű˳ */
+    size_t ncopies;
+    PtrSet nodes;         /* ҪժµĽڵ */
+    PtrSet parents;       /* ɨĸڵ */
+} ApplyPrep;
+
+/* owned Ϊ 1 ʱͬ׼ݺ͸һͷţʧʱΪ 0 ʱѹҵϣֻͷ */
+static void apply_prep_free(ApplyPrep* prep, int owned)
+{
+    if (owned)
+    {
+        for (size_t i = 0; i < prep->nlabels; ++i)
+        {
+            tree_mem_free(prep->labels[i]);
+        }
+        for (size_t i = 0; i < prep->ncopies; ++i)
+        {
+            tree_free(prep->copies[i]);
+        }
+    }
+    tree_mem_free(prep->labels);
+    tree_mem_free(prep->copies);
+    tree_mem_free((void*)prep->nodes.keys);
+    tree_mem_free((void*)prep->parents.keys);
+}
+
+static int apply_prepare(ApplyPrep* prep, const TreeEditScript* script)
+{
+    const TreeEdit* e = script->edits;
+    size_t relabels = 0;
+    size_t inserts = 0;
+    size_t nunlink = 0;
+    for (size_t t = 0; t < script->count; ++t)
+    {
+        if (e[t].type == TREE_EDIT_RELABEL)
+        {
+            relabels++;
+        }
+        else if (e[t].type == TREE_EDIT_INSERT)
+        {
+            inserts++;
+        }
+        else
+        {
+            nunlink++;
+        }
+    }
+
+    memset(prep, 0, sizeof(*prep));
+    if ((relabels > 0 && !(prep->labels = (char**)tree_mem_alloc(sizeof(char*) * relabels))) ||
+        (inserts > 0 && !(prep->copies = (TreeNode**)tree_mem_alloc(sizeof(TreeNode*) * inserts))) ||
+        (nunlink > 0 && (!ptrset_init(&prep->nodes, nunlink) || !ptrset_init(&prep->parents, nunlink))))
+    {
+        return -1;
+    }
+
+    for (size_t t = 0; t < script->count; ++t)
+    {
+        if (e[t].type == TREE_EDIT_RELABEL)
+        {
+            const char* src = e[t].source->data;
+            char* data = NULL;
+            if (src)
+            {
+                size_t len = strlen(src) + 1;
+                data = (char*)tree_mem_alloc(len);
+                if (!data)
+                {
+                    return -1;
+                }
+                memcpy(data, src, len);
+            }
+            prep->labels[prep->nlabels++] = data;
+        }
+        else if (e[t].type == TREE_EDIT_INSERT)
+        {
+            TreeNode* copy = copy_subtree(e[t].source);
+            if (!copy)
+            {
+                return -1;
+            }
+            prep->copies[prep->ncopies++] = copy;
+        }
+    }
+    return 0;
+}
+
+int tree_diff_apply(TreeNode** proot, const TreeEditScript* script)
+{
+    if (!proot || !script)
+    {
+        return -1;
+    }
+
+    ApplyPrep prep;
+    if (apply_prepare(&prep, script) != 0)
+    {
+        apply_prep_free(&prep, 1);
+        return -1;
+    }
+
+    size_t k = 0;
+    const TreeEdit* e = script->edits;
+
+    /* 1.  */
+    for (size_t i = 0; k < script->count && e[k].type == TREE_EDIT_RELABEL; ++k, ++i)
+    {
+        tree_mem_free(e[k].node->data);
+        e[k].node->data = prep.labels[i];
+    }
+
+    /* 2. Ҫɾƶԭڵĺժ£ÿڵֻɨһ */
+    for (size_t t = k; t < script->count; ++t)
+    {
+        if (e[t].type == TREE_EDIT_DELETE || e[t].type == TREE_EDIT_MOVE)
+        {
+            ptrset_add(&prep.nodes, e[t].node);
+        }
+    }
+
+    for (size_t t = k; t < script->count; ++t)
+    {
+        if (e[t].type != TREE_EDIT_DELETE && e[t].type != TREE_EDIT_MOVE)
+        {
+            continue;
+        }
+        /*  proot Ϊеļ */
+        const void* key = e[t].old_parent ? (const void*)e[t].old_parent : (const void*)proot;
+        if (!ptrset_add(&prep.parents, key))
+        {
+            continue;
+        }
+
+        TreeNode** link = child_link(proot, e[t].old_parent);
+        while (*link)
+        {
+            if (ptrset_has(&prep.nodes, *link))
+            {
+                *link = (*link)->next_sibling;
+            }
+            else
+            {
+                link = &(*link)->next_sibling;
+            }
+        }
+    }
+
+    /* 3. ͷɾ */
+    for (; k < script->count && e[k].type == TREE_EDIT_DELETE; ++k)
+    {
+        e[k].node->next_sibling = NULL;
+        tree_free(e[k].node);
+    }
+
+    /*
+     * 4. λõ롣λ±꣬δժµĺѱȷ˳
+     *    β뼴ɣͬһڵʱһελüߡ
+     */
+    TreeNode* last_parent = NULL;
+    TreeNode* last_node = NULL;
+    size_t last_pos = 0;
+    size_t next_copy = 0;
+    for (; k < script->count; ++k)
+    {
+        TreeNode* node = (e[k].type == TREE_EDIT_INSERT) ? prep.copies[next_copy++] : e[k].node;
+
+        TreeNode** link;
+        size_t at;
+        if (last_node && last_parent == e[k].parent && e[k].position > last_pos)
+        {
+            link = &last_node->next_sibling;
+            at = last_pos + 1;
+        }
+        else
+        {
+            link = child_link(proot, e[k].parent);
+            at = 0;
+        }
+
+        while (at < e[k].position && *link)
+        {
+            link = &(*link)->next_sibling;
+            at++;
+        }
+
+        node->next_sibling = *link;
+        *link = node;
+
+        last_parent = e[k].parent;
+        last_node = node;
+        last_pos = e[k].position;
+    }
+
+    apply_prep_free(&prep, 0);
+    return 0;
+}
+
+int tree_reload_from_file(TreeNode** proot, const char* filename, int* replaced)
+{
+    if (replaced)
+    {
+        *replaced = 0;
+    }
+    if (!proot)
+    {
+        return -1;
+    }
+
+    TreeNode* fresh = buildTreeFromFile(filename);
+    if (!fresh)
+    {
+        return -1;
+    }
+
+    if (*proot)
+    {
+        TreeEditScript* script = tree_diff(*proot, fresh);
+        if (script && tree_diff_apply(proot, script) == 0)
+        {
+            int applied = (int)script->count;
+            tree_edit_script_free(script);
+            tree_free(fresh);
+            return applied;
+        }
+        tree_edit_script_free(script);
+    }
+
+    /* ԭûʧܣʱֲ䣩滻 */
+    tree_free(*proot);
+    *proot = fresh;
+    if (replaced)
+    {
+        *replaced = 1;
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef TREE_DIFF_H
+#define TREE_DIFF_H
+
+#include <stddef.h>
+#include "tree.h"
+
+/* ༭ */
+typedef enum TreeEditType
+{
+    TREE_EDIT_RELABEL,   /* ޸ľɽڵ */
+    TREE_EDIT_DELETE,    /* ɾе */
+    TREE_EDIT_MOVE,      /* Ѿеƶλ */
+    TREE_EDIT_INSERT     /* еƣ */
+} TreeEditType;
+
+/*
+ * һ༭parent / old_parent ָеĽڵ㣬NULL ʾ㣨root ڵֵ
+ * position ΪӦȫ༭Ŀ길ڵ㺢е±꣨ 0 ʼ
+ */
+typedef struct TreeEdit
+{
+    TreeEditType type;
+    TreeNode* node;            /* RELABEL/DELETE/MOVEеĽڵ */
+    const TreeNode* source;    /* RELABELԴINSERTҪƵ */
+    TreeNode* old_parent;      /* DELETE/MOVEԭڵ */
+    TreeNode* parent;          /* INSERT/MOVEĿ길ڵ */
+    size_t position;           /* INSERT/MOVEĿλ */
+} TreeEdit;
+
+/*
+ * ༭űȸɾ󰴸ڵλõز/ƶ˳У
+ * tree_diff_apply һ˳
+ */
+typedef struct TreeEditScript
+{
+    TreeEdit* edits;
+    size_t count;
+    size_t cap;
+} TreeEditScript;
+
+/*
+ *  old_root Ϊ new_root ı༭ű߶ɭִ
+ * ϣȫͬƥ䡢룻ʧܷ NULL
+ * űеĽڵ㣬Ӧǰܱ޸Ļͷš
+ */
+TreeEditScript* tree_diff(TreeNode* old_root, const TreeNode* new_root);
+void tree_edit_script_free(TreeEditScript* script);
+
+/*
+ * ѽűӦõϣ*proot 򶥲仯¡
+ * δ༭漰Ľڵ㱣ԭַ䡣ɹ 0
+ * ڴ棨ݡĸ޸֮ǰȫ䣬ڴ治ʱ -1 ֲ䡣
+ */
+int tree_diff_apply(TreeNode** proot, const TreeEditScript* script);
+
+/*
+ * ¼أȡ filenamebuildTreeFromFile ʽֻѲӦõ *proot
+ * Ӧõı༭ļȡʧܷ -1 ԭ䡣
+ * ԭû㡢Ӧʧܣ滻Ϊ¶ȡ 0  *replaced  1
+ * ɹʱ *replaced Ϊ 0replaced Ϊ NULL
+ */
+int tree_reload_from_file(TreeNode** proot, const char* filename, int* replaced);
+
+#endif /* TREE_DIFF_H */
@@ -0,0 +1,750 @@
+#include <stdlib.h>
+#include <string.h>
+#include "tree_hash.h"
+
+/* պɭֵĹϣ */
+#define TREE_HASH_EMPTY 0x9E3779B97F4A7C15ULL
+
+/* 64 λϺsplitmix64 ĩˣִɢ */
+static uint64_t mix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+/* ڵݵĹϣFNV-1aNULL մֿ */
+static uint64_t hash_str(const char* s)
+{
+    if (!s)
+    {
+        return 0x6A09E667F3BCC909ULL;
+    }
+
+    uint64_t h = 0xCBF29CE484222325ULL;
+    while (*s)
+    {
+        h ^= (unsigned char)*s++;
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+/* ڵϣ = f(ݹϣ, ɭֹϣ) */
+static uint64_t combine_subtree(uint64_t data_hash, uint64_t children_hash)
+{
+    return mix64(data_hash ^ mix64(children_hash + 0x243F6A8885A308D3ULL));
+}
+
+/* ɭֹϣ۵˳ */
+static uint64_t combine_forest(uint64_t acc, uint64_t subtree_hash)
+{
+    return mix64(acc * 0x9FB21C651E98DF25ULL + subtree_hash);
+}
+
+static int str_equal(const char* a, const char* b)
+{
+    if (!a || !b)
+    {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+/* ---------------- ǵݹϣ ---------------- */
+
+/*
+ * ÿһջ֡node Ϊǰڵ㣨ײ֡Ϊ NULL
+ * cur Ϊһĺӣacc/size ΪѴ۵ɭֹϣڵ
+ * ջֻйأֵ޹ء
+ */
+typedef struct HashFrame
+{
+    const TreeNode* node;
+    const TreeNode* cur;
+    uint64_t acc;
+    size_t size;
+} HashFrame;
+
+typedef int (*hash_visit_fn)(void* ctx, const TreeNode* node, TreeHash sub);
+
+static int hash_frame_push(HashFrame** pstack, size_t* pcap, size_t* psp, const TreeNode* node, const TreeNode* first)
+{
+    if (*psp >= *pcap)
+    {
+        size_t newcap = (*pcap == 0) ? 64 : (*pcap * 2);
+        HashFrame* ns = (HashFrame*)tree_mem_realloc(*pstack, sizeof(HashFrame) * newcap);
+        if (!ns)
+        {
+            return 0;
+        }
+        *pstack = ns;
+        *pcap = newcap;
+    }
+
+    HashFrame* f = &(*pstack)[(*psp)++];
+    f->node = node;
+    f->cur = first;
+    f->acc = TREE_HASH_EMPTY;
+    f->size = 0;
+    return 1;
+}
+
+/*  first ͷֵɭֵĹϣÿڵص visitڴ治㷵 0 */
+static int hash_forest(const TreeNode* first, hash_visit_fn visit, void* ctx, TreeHash* out)
+{
+    HashFrame* stack = NULL;
+    size_t cap = 0;
+    size_t sp = 0;
+
+    if (!hash_frame_push(&stack, &cap, &sp, NULL, first))
+    {
+        return 0;
+    }
+
+    for (;;)
+    {
+        HashFrame* f = &stack[sp - 1];
+        if (f->cur)
+        {
+            const TreeNode* c = f->cur;
+            f->cur = c->next_sibling;
+            if (!hash_frame_push(&stack, &cap, &sp, c, c->first_child))
+            {
+                tree_mem_free(stack);
+                return 0;
+            }
+            continue;
+        }
+
+        /* ײ֡Ƭɭִ */
+        if (!f->node)
+        {
+            out->value = f->acc;
+            out->size = f->size;
+            break;
+        }
+
+        TreeHash sub;
+        sub.value = combine_subtree(hash_str(f->node->data), f->acc);
+        sub.size = 1 + f->size;
+        if (visit && !visit(ctx, f->node, sub))
+        {
+            tree_mem_free(stack);
+            return 0;
+        }
+
+        sp--;
+        HashFrame* parent = &stack[sp - 1];
+        parent->acc = combine_forest(parent->acc, sub.value);
+        parent->size += sub.size;
+    }
+
+    tree_mem_free(stack);
+    return 1;
+}
+
+TreeHash tree_hash_subtree(const TreeNode* node)
+{
+    TreeHash h = { 0, 0 };
+    if (!node)
+    {
+        return h;
+    }
+
+    TreeHash children;
+    if (!hash_forest(node->first_child, NULL, NULL, &children))
+    {
+        return h;
+    }
+
+    h.value = combine_subtree(hash_str(node->data), children.value);
+    h.size = 1 + children.size;
+    return h;
+}
+
+int tree_hash_same(TreeHash a, TreeHash b)
+{
+    return a.value == b.value && a.size == b.size;
+}
+
+/* ---------------- ϣڵָ -> ϣ ---------------- */
+
+struct TreeHashIndex
+{
+    const TreeNode** keys;   /* ŶַNULL Ϊղ */
+    TreeHash* values;
+    size_t cap;              /* 2  */
+    size_t count;
+};
+
+static size_t ptr_slot(const void* p, size_t cap)
+{
+    return (size_t)(mix64((uint64_t)(uintptr_t)p) & (uint64_t)(cap - 1));
+}
+
+static int index_rehash(TreeHashIndex* idx, size_t newcap)
+{
+    const TreeNode** keys = (const TreeNode**)tree_mem_calloc(newcap, sizeof(TreeNode*));
+    TreeHash* values = (TreeHash*)tree_mem_alloc(sizeof(TreeHash) * newcap);
+    if (!keys || !values)
+    {
+        tree_mem_free((void*)keys);
+        tree_mem_free(values);
+        return 0;
+    }
+
+    for (size_t i = 0; i < idx->cap; ++i)
+    {
+        if (idx->keys[i])
+        {
+            size_t s = ptr_slot(idx->keys[i], newcap);
+            while (keys[s])
+            {
+                s = (s + 1) & (newcap - 1);
+            }
+            keys[s] = idx->keys[i];
+            values[s] = idx->values[i];
+        }
+    }
+
+    tree_mem_free((void*)idx->keys);
+    tree_mem_free(idx->values);
+    idx->keys = keys;
+    idx->values = values;
+    idx->cap = newcap;
+    return 1;
+}
+
+static int index_visit(void* ctx, const TreeNode* node, TreeHash sub)
+{
+    TreeHashIndex* idx = (TreeHashIndex*)ctx;
+
+    /* װӱ 1/2  */
+    if ((idx->count + 1) * 2 > idx->cap)
+    {
+        if (!index_rehash(idx, idx->cap * 2))
+        {
+            return 0;
+        }
+    }
+
+    size_t s = ptr_slot(node, idx->cap);
+    while (idx->keys[s] && idx->keys[s] != node)
+    {
+        s = (s + 1) & (idx->cap - 1);
+    }
+    if (!idx->keys[s])
+    {
+        idx->count++;
+    }
+    idx->keys[s] = node;
+    idx->values[s] = sub;
+    return 1;
+}
+
+TreeHashIndex* tree_hash_index_build(const TreeNode* root)
+{
+    TreeHashIndex* idx = (TreeHashIndex*)tree_mem_calloc(1, sizeof(TreeHashIndex));
+    if (!idx)
+    {
+        return NULL;
+    }
+
+    if (!index_rehash(idx, 64))
+    {
+        tree_mem_free(idx);
+        return NULL;
+    }
+
+    TreeHash forest;
+    if (!hash_forest(root, index_visit, idx, &forest))
+    {
+        tree_hash_index_free(idx);
+        return NULL;
+    }
+
+    return idx;
+}
+
+void tree_hash_index_free(TreeHashIndex* index)
+{
+    if (!index)
+    {
+        return;
+    }
+
+    tree_mem_free((void*)index->keys);
+    tree_mem_free(index->values);
+    tree_mem_free(index);
+}
+
+int tree_hash_index_get(const TreeHashIndex* index, const TreeNode* node, TreeHash* out)
+{
+    if (!index || !node)
+    {
+        return 0;
+    }
+
+    size_t s = ptr_slot(node, index->cap);
+    while (index->keys[s])
+    {
+        if (index->keys[s] == node)
+        {
+            if (out)
+            {
+                *out = index->values[s];
+            }
+            return 1;
+        }
+        s = (s + 1) & (index->cap - 1);
+    }
+
+    return 0;
+}
+
+int tree_hash_index_equal(const TreeHashIndex* index, const TreeNode* a, const TreeNode* b)
+{
+    TreeHash ha;
+    TreeHash hb;
+    if (!tree_hash_index_get(index, a, &ha) || !tree_hash_index_get(index, b, &hb))
+    {
+        return 0;
+    }
+
+    return tree_hash_same(ha, hb);
+}
+
+/* ȷȽϣջÿ֡һͬǰĺα */
+int tree_subtree_equal(const TreeNode* a, const TreeNode* b)
+{
+    if (!a || !b)
+    {
+        return a == b;
+    }
+
+    if (!str_equal(a->data, b->data))
+    {
+        return 0;
+    }
+
+    size_t cap = 64;
+    size_t sp = 0;
+    const TreeNode** stack = (const TreeNode**)tree_mem_alloc(sizeof(TreeNode*) * 2 * cap);
+    if (!stack)
+    {
+        return 0;
+    }
+
+    stack[0] = a->first_child;
+    stack[1] = b->first_child;
+    sp = 1;
+
+    int equal = 1;
+    while (sp > 0)
+    {
+        const TreeNode** top = &stack[(sp - 1) * 2];
+        const TreeNode* x = top[0];
+        const TreeNode* y = top[1];
+        if (!x || !y)
+        {
+            if (x != y)
+            {
+                equal = 0;
+                break;
+            }
+            sp--;
+            continue;
+        }
+
+        if (!str_equal(x->data, y->data))
+        {
+            equal = 0;
+            break;
+        }
+
+        /* ǰһֵܣ½ */
+        top[0] = x->next_sibling;
+        top[1] = y->next_sibling;
+
+        if (sp >= cap)
+        {
+            cap *= 2;
+            const TreeNode** ns = (const TreeNode**)tree_mem_realloc((void*)stack, sizeof(TreeNode*) * 2 * cap);
+            if (!ns)
+            {
+                equal = 0;
+                break;
+            }
+            stack = ns;
+        }
+        stack[sp * 2] = x->first_child;
+        stack[sp * 2 + 1] = y->first_child;
+        sp++;
+    }
+
+    tree_mem_free((void*)stack);
+    return equal;
+}
+
+/* ---------------- ϣ DAG ---------------- */
+
+typedef struct DagEntry
+{
+    TreeNode* node;   /* NULL Ϊղ */
+    uint64_t hash;
+    size_t refs;
+} DagEntry;
+
+struct TreeDag
+{
+    DagEntry* table;
+    size_t cap;       /* 2  */
+    size_t count;
+};
+
+/* DAG ڵļ + ѹ淶ĺֵָ */
+static uint64_t dag_key_hash(const char* data, const TreeNode* child, const TreeNode* sibling)
+{
+    uint64_t h = hash_str(data);
+    h ^= mix64((uint64_t)(uintptr_t)child + 0x452821E638D01377ULL);
+    h = mix64(h) ^ (uint64_t)(uintptr_t)sibling;
+    return mix64(h);
+}
+
+static int dag_rehash(TreeDag* dag, size_t newcap)
+{
+    DagEntry* table = (DagEntry*)tree_mem_calloc(newcap, sizeof(DagEntry));
+    if (!table)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0; i < dag->cap; ++i)
+    {
+        if (dag->table[i].node)
+        {
+            size_t s = (size_t)(dag->table[i].hash & (newcap - 1));
+            while (table[s].node)
+            {
+                s = (s + 1) & (newcap - 1);
+            }
+            table[s] = dag->table[i];
+        }
+    }
+
+    tree_mem_free(dag->table);
+    dag->table = table;
+    dag->cap = newcap;
+    return 1;
+}
+
+/* ҽڵڵĲλ */
+static size_t dag_find_slot(const TreeDag* dag, const TreeNode* node)
+{
+    uint64_t h = dag_key_hash(node->data, node->first_child, node->next_sibling);
+    size_t s = (size_t)(h & (dag->cap - 1));
+    while (dag->table[s].node != node)
+    {
+        s = (s + 1) & (dag->cap - 1);
+    }
+    return s;
+}
+
+/* ̽ĺɾĹ */
+static void dag_remove_slot(TreeDag* dag, size_t s)
+{
+    size_t mask = dag->cap - 1;
+    size_t hole = s;
+    size_t j = s;
+
+    dag->table[hole].node = NULL;
+    for (;;)
+    {
+        j = (j + 1) & mask;
+        if (!dag->table[j].node)
+        {
+            break;
+        }
+
+        size_t home = (size_t)(dag->table[j].hash & mask);
+        /* home  (hole, j] ʱĿǰն */
+        if (((j - home) & mask) >= ((j - hole) & mask))
+        {
+            dag->table[hole] = dag->table[j];
+            dag->table[j].node = NULL;
+            hole = j;
+        }
+    }
+    dag->count--;
+}
+
+/* üһĽڵժϣ data ֶδɴ */
+static void dag_unref(TreeDag* dag, TreeNode* node, TreeNode** dead)
+{
+    if (!node)
+    {
+        return;
+    }
+
+    size_t s = dag_find_slot(dag, node);
+    if (--dag->table[s].refs > 0)
+    {
+        return;
+    }
+
+    dag_remove_slot(dag, s);
+    tree_mem_free(node->data);
+    node->data = (char*)*dead;
+    *dead = node;
+}
+
+void tree_dag_release(TreeDag* dag, TreeNode* root)
+{
+    if (!dag || !root)
+    {
+        return;
+    }
+
+    TreeNode* dead = NULL;
+    dag_unref(dag, root, &dead);
+
+    /* գֵһ */
+    while (dead)
+    {
+        TreeNode* x = dead;
+        dead = (TreeNode*)x->data;
+        dag_unref(dag, x->first_child, &dead);
+        dag_unref(dag, x->next_sibling, &dead);
+        tree_mem_free(x);
+    }
+}
+
+/*
+ * ȡ (data, child, sibling) ӦĹ淶ڵ㣬صĽڵü +1
+ * child  sibling ɵƽ½ڵʱתΪڵӣ
+ * нڵʱ黹ʧܷ NULLͬ黹ߵá
+ */
+static TreeNode* dag_intern_triple(TreeDag* dag, const char* data, TreeNode* child, TreeNode* sibling)
+{
+    uint64_t h = dag_key_hash(data, child, sibling);
+    size_t s = (size_t)(h & (dag->cap - 1));
+    while (dag->table[s].node)
+    {
+        TreeNode* n = dag->table[s].node;
+        if (dag->table[s].hash == h && n->first_child == child && n->next_sibling == sibling && str_equal(n->data, data))
+        {
+            dag->table[s].refs++;
+            /* нڵ㱾ͳ child/siblingߵòʹ */
+            TreeNode* dead = NULL;
+            dag_unref(dag, child, &dead);
+            dag_unref(dag, sibling, &dead);
+            return n;
+        }
+        s = (s + 1) & (dag->cap - 1);
+    }
+
+    TreeNode* node = NULL;
+    if ((dag->count + 1) * 2 <= dag->cap || dag_rehash(dag, dag->cap * 2))
+    {
+        node = tree_create_node(data);
+        if (node && data && !node->data)
+        {
+            tree_mem_free(node);
+            node = NULL;
+        }
+    }
+
+    if (!node)
+    {
+        tree_dag_release(dag, child);
+        tree_dag_release(dag, sibling);
+        return NULL;
+    }
+
+    node->first_child = child;
+    node->next_sibling = sibling;
+
+    s = (size_t)(h & (dag->cap - 1));
+    while (dag->table[s].node)
+    {
+        s = (s + 1) & (dag->cap - 1);
+    }
+    dag->table[s].node = node;
+    dag->table[s].hash = h;
+    dag->table[s].refs = 1;
+    dag->count++;
+    return node;
+}
+
+TreeDag* tree_dag_create(void)
+{
+    TreeDag* dag = (TreeDag*)tree_mem_calloc(1, sizeof(TreeDag));
+    if (!dag)
+    {
+        return NULL;
+    }
+
+    dag->cap = 64;
+    dag->table = (DagEntry*)tree_mem_calloc(dag->cap, sizeof(DagEntry));
+    if (!dag->table)
+    {
+        tree_mem_free(dag);
+        return NULL;
+    }
+
+    return dag;
+}
+
+/*
+ * ƽ DAG ҪҲֵܵĹ淶ڵ㣬ÿɺӵ
+ * (Դڵ, 淶) ݴ pending У󴮳ֵ
+ */
+typedef struct DagPending
+{
+    const TreeNode* src;
+    TreeNode* children;   /* һ */
+} DagPending;
+
+typedef struct DagFrame
+{
+    const TreeNode* node;
+    const TreeNode* cur;
+    size_t base;          /*  pending еʼλ */
+} DagFrame;
+
+TreeNode* tree_dag_intern(TreeDag* dag, const TreeNode* root)
+{
+    if (!dag || !root)
+    {
+        return NULL;
+    }
+
+    size_t fcap = 64;
+    size_t pcap = 64;
+    size_t sp = 0;
+    size_t pn = 0;
+    DagFrame* frames = (DagFrame*)tree_mem_alloc(sizeof(DagFrame) * fcap);
+    DagPending* pending = (DagPending*)tree_mem_alloc(sizeof(DagPending) * pcap);
+    TreeNode* result = NULL;
+    int ok = 1;
+
+    if (!frames || !pending)
+    {
+        tree_mem_free(frames);
+        tree_mem_free(pending);
+        return NULL;
+    }
+
+    frames[0].node = NULL;
+    frames[0].cur = root;
+    frames[0].base = 0;
+    sp = 1;
+
+    while (ok)
+    {
+        DagFrame* f = &frames[sp - 1];
+        if (f->cur)
+        {
+            const TreeNode* c = f->cur;
+            f->cur = c->next_sibling;
+            if (sp >= fcap)
+            {
+                DagFrame* nf = (DagFrame*)tree_mem_realloc(frames, sizeof(DagFrame) * fcap * 2);
+                if (!nf)
+                {
+                    ok = 0;
+                    break;
+                }
+                frames = nf;
+                fcap *= 2;
+            }
+            frames[sp].node = c;
+            frames[sp].cur = c->first_child;
+            frames[sp].base = pn;
+            sp++;
+            continue;
+        }
+
+        /* 㺢ȫɣ󴮳ɹ淶ֵ */
+        TreeNode* chain = NULL;
+        while (pn > f->base)
+        {
+            DagPending* p = &pending[--pn];
+            chain = dag_intern_triple(dag, p->src->data, p->children, chain);
+            if (!chain)
+            {
+                ok = 0;
+                break;
+            }
+        }
+        if (!ok)
+        {
+            break;
+        }
+
+        if (!f->node)
+        {
+            result = chain;
+            break;
+        }
+
+        if (pn >= pcap)
+        {
+            DagPending* np = (DagPending*)tree_mem_realloc(pending, sizeof(DagPending) * pcap * 2);
+            if (!np)
+            {
+                tree_dag_release(dag, chain);
+                ok = 0;
+                break;
+            }
+            pending = np;
+            pcap *= 2;
+        }
+        pending[pn].src = f->node;
+        pending[pn].children = chain;
+        pn++;
+        sp--;
+    }
+
+    if (!ok)
+    {
+        /* 黹ݴ */
+        while (pn > 0)
+        {
+            tree_dag_release(dag, pending[--pn].children);
+        }
+    }
+
+    tree_mem_free(frames);
+    tree_mem_free(pending);
+    return result;
+}
+
+size_t tree_dag_unique_nodes(const TreeDag* dag)
+{
+    return dag ? dag->count : 0;
+}
+
+void tree_dag_free(TreeDag* dag)
+{
+    if (!dag)
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < dag->cap; ++i)
+    {
+        if (dag->table[i].node)
+        {
+            tree_mem_free(dag->table[i].node->data);
+            tree_mem_free(dag->table[i].node);
+        }
+    }
+
+    tree_mem_free(dag->table);
+    tree_mem_free(dag);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#ifndef TREE_HASH_H
+#define TREE_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "tree.h"
+
+/*
+ * ṹϣMerkle ϣ
+ * ָһڵ㼰ȫýڵֵܣ
+ * ϣԵϼ㣬ͬʱǽڵ״˳У
+ */
+typedef struct TreeHash
+{
+    uint64_t value;   /* ϣֵ */
+    size_t size;      /* ڵϣһȽϿɽһײ */
+} TreeHash;
+
+/* ĳڵĹϣO(С)node Ϊ NULL ʱ {0, 0} */
+TreeHash tree_hash_subtree(const TreeNode* node);
+
+/* ϣǷͬײԼ 2^-64 */
+int tree_hash_same(TreeHash a, TreeHash b);
+
+/*
+ * ϣһαΪroot ֵɵɭ֣ÿڵ㻺ϣ
+ * ֮ȱȽ϶ O(1)
+ * ֻڵָ룬ṹı¹
+ */
+typedef struct TreeHashIndex TreeHashIndex;
+
+TreeHashIndex* tree_hash_index_build(const TreeNode* root);
+void tree_hash_index_free(TreeHashIndex* index);
+
+/* ѯڵϣڵ㲻з 0򷵻 1 д out */
+int tree_hash_index_get(const TreeHashIndex* index, const TreeNode* node, TreeHash* out);
+
+/* O(1) жͬһǷͬһڵ㲻ʱ 0 */
+int tree_hash_index_equal(const TreeHashIndex* index, const TreeNode* a, const TreeNode* b);
+
+/* ڵ㾫ȷȽڵ㼰Ҫųϣײĳ */
+int tree_subtree_equal(const TreeNode* a, const TreeNode* b);
+
+/*
+ * ϣhash-consingͬӽṹϲΪ DAG
+ *  (data, first_child, next_sibling) ԪΪ淶ڵ㣬
+ * ͬĺֻһݣڵü
+ * ƣڵԴ next_siblingĵλǡڵֵͬܡֵĹ׺
+ * ͬŲֵͬܣͬһģ临Ƶڵ£
+ * ԼֵǰĽڵÿһݣµȫֻһݣ
+ * ÿһֻռһڵ㡣ҪҲֵŵ֮⣬
+ * صľͲͨ TreeNode*
+ * صĸͨ TreeNode*ֻӿڣͳơҡӡֱʹã
+ * ܶ tree_free ޸ṹӦʹ tree_dag_release ͷš
+ */
+typedef struct TreeDag TreeDag;
+
+TreeDag* tree_dag_create(void);
+
+/*  root ɭָƽ DAG عĸü +1ʧܷ NULLroot ޸ */
+TreeNode* tree_dag_intern(TreeDag* dag, const TreeNode* root);
+
+/* ͷһ tree_dag_intern õãĽڵͬ䲻ٱõĺһ */
+void tree_dag_release(TreeDag* dag, TreeNode* root);
+
+/* DAG ʵʴ洢ĽڵĽڵ */
+size_t tree_dag_unique_nodes(const TreeDag* dag);
+
+/*  DAG нڵ㣬֮ǰصĸȫʧЧ */
+void tree_dag_free(TreeDag* dag);
+
+#endif /* TREE_HASH_H */
@@ -0,0 +1,24 @@
+#pragma once
+#ifndef TREE_INTERNAL_H
+#define TREE_INTERNAL_H
+
+/* ڲڶӿ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include "tree.h"
+
+/*
+ * ع̼ӣÿȡһڵصһ on_progress
+ * bytes ΪѶȡֽnodes / total ΪѴڵڵط 0 ֹء
+ */
+typedef struct TreeLoadMonitor
+{
+    int (*on_progress)(void* ctx, size_t bytes, size_t nodes, size_t total);
+    void* ctx;
+} TreeLoadMonitor;
+
+/* Ѵ򿪵ļȡ buildTreeFromFile ʽر fpmonitor Ϊ NULL */
+TreeNode* tree_build_from_fp(FILE* fp, const TreeLoadMonitor* monitor);
+
+#endif /* TREE_INTERNAL_H */
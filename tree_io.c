@@ -0,0 +1,1023 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tree_io.h"
+#include "tree_traverse.h"
+
+#define IO_READ_CHUNK (1u << 20)
+#define IO_NONE ((size_t)-1)
+#define IO_BATCH 16   /* һԤȡļ */
+#define IO_WRITE_BUFFER (1u << 20)
+#define IO_INDEX_DATA_MAX 255   /* buildTreeFromFile  %255s ȡ */
+
+/* Ԥȡֻʾֵ֧ıΪղ */
+#if defined(__GNUC__) || defined(__clang__)
+#define IO_PREFETCH(p) __builtin_prefetch(p)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#define IO_PREFETCH(p) _mm_prefetch((const char*)(p), _MM_HINT_T0)
+#else
+#define IO_PREFETCH(p) ((void)(p))
+#endif
+
+/* еһֶΣtext е볤 */
+typedef struct IoField
+{
+    size_t off;
+    size_t len;
+} IoField;
+
+/* ռ used ֽʱܷٷ more ֽڣbudget Ϊ 0 ʾ */
+static int io_within_budget(size_t budget, size_t used, size_t more)
+{
+    return budget == 0 || (used <= budget && more <= budget - used);
+}
+
+/*
+ * ʣһڴ棬ĩβ '\0'*out_bytes ΪÿĴС
+ * 尴󣬵Ԥ㣬װʱʧܷ NULL
+ */
+static char* io_read_all(FILE* fp, size_t budget, size_t* out_len, size_t* out_bytes)
+{
+    size_t cap = IO_READ_CHUNK;
+    if (budget != 0 && cap >= budget)
+    {
+        cap = budget - 1;
+    }
+    size_t len = 0;
+    char* buf = (char*)tree_mem_alloc(cap + 1);
+    if (!buf)
+    {
+        return NULL;
+    }
+
+    for (;;)
+    {
+        if (len == cap)
+        {
+            size_t newcap = cap * 2;
+            if (budget != 0 && newcap >= budget)
+            {
+                newcap = budget - 1;
+            }
+            if (newcap <= cap)
+            {
+                /* ѵԤޣǡöɹ */
+                if (getc(fp) == EOF && !ferror(fp))
+                {
+                    break;
+                }
+                tree_mem_free(buf);
+                return NULL;
+            }
+            char* nb = (char*)tree_mem_realloc(buf, newcap + 1);
+            if (!nb)
+            {
+                tree_mem_free(buf);
+                return NULL;
+            }
+            buf = nb;
+            cap = newcap;
+        }
+        size_t got = fread(buf + len, 1, cap - len, fp);
+        if (got == 0)
+        {
+            break;
+        }
+        len += got;
+    }
+
+    if (ferror(fp))
+    {
+        tree_mem_free(buf);
+        return NULL;
+    }
+    buf[len] = '\0';
+    *out_len = len;
+    *out_bytes = cap + 1;
+    return buf;
+}
+
+/* Ͻ磨з + 1һԷ䰴е */
+static size_t io_count_lines(const char* text, size_t len)
+{
+    size_t lines = 1;
+    const char* p = text;
+    const char* end = text + len;
+    while ((p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL)
+    {
+        lines++;
+        p++;
+    }
+    return lines;
+}
+
+/* ȡ *pos ʼһУ[*begin, *end) ĩ '\r'ûиʱ 0 */
+static int io_next_line(const char* text, size_t len, size_t* pos, size_t* begin, size_t* end)
+{
+    if (*pos >= len)
+    {
+        return 0;
+    }
+
+    const char* nl = (const char*)memchr(text + *pos, '\n', len - *pos);
+    size_t stop = nl ? (size_t)(nl - text) : len;
+    *begin = *pos;
+    *pos = nl ? stop + 1 : len;
+    while (stop > *begin && text[stop - 1] == '\r')
+    {
+        stop--;
+    }
+    *end = stop;
+    return 1;
+}
+
+static int io_is_blank(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/* հ׺ȡ [*pos, end) еһֶΣûֶʱ 0 */
+static int io_next_field(const char* text, size_t* pos, size_t end, IoField* field)
+{
+    size_t p = *pos;
+    while (p < end && io_is_blank(text[p]))
+    {
+        p++;
+    }
+    if (p == end)
+    {
+        *pos = p;
+        return 0;
+    }
+
+    field->off = p;
+    while (p < end && !io_is_blank(text[p]))
+    {
+        p++;
+    }
+    field->len = p - field->off;
+    *pos = p;
+    return 1;
+}
+
+/* ŵڵŵĿŶַɢбֱıи */
+typedef struct IoIdMap
+{
+    size_t* slots;          /* ڵ + 10 ʾղ */
+    size_t mask;
+    const char* text;
+    const IoField* keys;    /* keys[i] Ϊڵ i ı */
+} IoIdMap;
+
+/*  max_keys ĲС 2  */
+static size_t io_map_capacity(size_t max_keys)
+{
+    size_t cap = 16;
+    while (cap < max_keys * 2)
+    {
+        cap *= 2;
+    }
+    return cap;
+}
+
+static int io_map_init(IoIdMap* map, size_t max_keys, const char* text, const IoField* keys)
+{
+    size_t cap = io_map_capacity(max_keys);
+    map->slots = (size_t*)tree_mem_calloc(cap, sizeof(size_t));
+    map->mask = cap - 1;
+    map->text = text;
+    map->keys = keys;
+    return map->slots != NULL;
+}
+
+/* FNV-1a */
+static size_t io_hash(const char* s, size_t len)
+{
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)s[i];
+        h *= 1099511628211ULL;
+    }
+    return (size_t)(h ^ (h >> 32));
+}
+
+/*
+ * һɢֵԤȡԵĲλɢбԶڻʱҵÿδжҪȴ
+ * ΪԤȡңЩδоصС
+ */
+static void io_map_prepare(const IoIdMap* map, const IoField* keys, size_t count, size_t* hashes)
+{
+    for (size_t k = 0; k < count; ++k)
+    {
+        hashes[k] = io_hash(map->text + keys[k].off, keys[k].len);
+        IO_PREFETCH(&map->slots[hashes[k] & map->mask]);
+    }
+}
+
+/*
+ * ɢֵΪ hash ı keyʱеţ candidate Ϊ IO_NONE ʱ벢 candidate
+ * Ϊ IO_NONE ʱֻҡ IO_NONEǰ keys[candidate]
+ */
+static size_t io_map_find_or_insert(IoIdMap* map, IoField key, size_t hash, size_t candidate)
+{
+    const char* s = map->text + key.off;
+    size_t i = hash & map->mask;
+    while (map->slots[i] != 0)
+    {
+        size_t idx = map->slots[i] - 1;
+        const IoField* k = &map->keys[idx];
+        if (k->len == key.len && memcmp(map->text + k->off, s, key.len) == 0)
+        {
+            return idx;
+        }
+        i = (i + 1) & map->mask;
+    }
+
+    if (candidate != IO_NONE)
+    {
+        map->slots[i] = candidate + 1;
+    }
+    return candidate;
+}
+
+/*
+ * ÿڵĸڵţΪ IO_NONEһused Ϊߴʱռõֽ
+ * ͬһܳڴԤ㡣
+ * seq ֵ˳гȫ n ڵ㣨NULL ʾ 0..n-1ڵȶ
+ * ͬһڵĺ sorted ұ seq е˳򣬵 0 Ǹ
+ * 󰴲˳ýڵ㣺 order ˳ȡÿһڵͰĺ׷ӵβ
+ * ֵͬڿڣʻԱصִС
+ * õĽڵ n ˵лϵĽڵκθˣ
+ */
+static TreeNode* io_build_block(size_t n, const size_t* parent, const size_t* seq,
+    const char* text, const IoField* labels, size_t used)
+{
+    size_t string_bytes = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        string_bytes += labels[i].len + 1;
+    }
+
+    size_t node_bytes = n * sizeof(TreeNode);
+    size_t sort_bytes = (n + 2 + 2 * n) * sizeof(size_t);
+    if (!io_within_budget(tree_get_memory_budget(), used, sort_bytes + node_bytes + string_bytes))
+    {
+        return NULL;
+    }
+
+    /*
+     *  0 Ϊ p + 1 Ϊڵ p ĺӡ group[k + 1] ǰ׺͵õ㣬
+     *  seq ˳ group[k] ǰƵ k յ㣬 k λ [group[k - 1], group[k])group[-1] Ϊ 0
+     */
+    size_t* group = (size_t*)tree_mem_calloc(n + 2, sizeof(size_t));
+    size_t* sorted = (size_t*)tree_mem_alloc(sizeof(size_t) * n);
+    size_t* order = (size_t*)tree_mem_alloc(sizeof(size_t) * n);
+    TreeNode* block = (TreeNode*)tree_mem_alloc(node_bytes + string_bytes);
+    if (!group || !sorted || !order || !block)
+    {
+        tree_mem_free(group);
+        tree_mem_free(sorted);
+        tree_mem_free(order);
+        tree_mem_free(block);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        group[(parent[i] == IO_NONE) ? 1 : parent[i] + 2]++;
+    }
+    for (size_t k = 1; k < n + 2; ++k)
+    {
+        group[k] += group[k - 1];
+    }
+    for (size_t j = 0; j < n; ++j)
+    {
+        size_t v = seq ? seq[j] : j;
+        sorted[group[(parent[v] == IO_NONE) ? 0 : parent[v] + 1]++] = v;
+    }
+
+    /* ׷һֵʱ֮ next_siblingڵʱֻݺ first_child */
+    size_t tail = group[0];
+    memcpy(order, sorted, sizeof(size_t) * tail);
+    for (size_t k = 0; k < tail; ++k)
+    {
+        block[k].next_sibling = (k + 1 < tail) ? &block[k + 1] : NULL;
+    }
+
+    char* out = (char*)block + node_bytes;
+    size_t i = 0;
+    for (; i < tail; ++i)
+    {
+        size_t v = order[i];
+        TreeNode* node = &block[i];
+        memcpy(out, text + labels[v].off, labels[v].len);
+        out[labels[v].len] = '\0';
+        node->data = out;
+        out += labels[v].len + 1;
+
+        /*  v + 1  v ĺ */
+        size_t begin = group[v];
+        size_t count = group[v + 1] - begin;
+        if (count == 0)
+        {
+            node->first_child = NULL;
+            continue;
+        }
+        node->first_child = &block[tail];
+        memcpy(order + tail, sorted + begin, sizeof(size_t) * count);
+        for (size_t k = tail; k < tail + count; ++k)
+        {
+            block[k].next_sibling = (k + 1 < tail + count) ? &block[k + 1] : NULL;
+        }
+        tail += count;
+    }
+
+    tree_mem_free(group);
+    tree_mem_free(sorted);
+    tree_mem_free(order);
+    if (i != n)
+    {
+        tree_mem_free(block);
+        return NULL;
+    }
+    return block;
+}
+
+/* ڵбʾûиڵ㡱д */
+static int io_is_root_marker(const char* s, size_t len)
+{
+    return (len == 1 && s[0] == '-') || (len == 2 && s[0] == '-' && s[1] == '1');
+}
+
+/* عе븨飬Ͻһη */
+typedef struct IoLoader
+{
+    char* text;
+    size_t len;
+    IoField* ids;       /* ڵţ߱ͬʱΪǩ */
+    IoField* fields;    /* ڵţ߱в */
+    IoField* labels;    /* ڵǩ */
+    size_t* parent;
+    size_t* seq;        /* ֵ߱˳ */
+    IoIdMap map;
+    size_t n;
+    size_t used;        /* ռõֽԤ */
+} IoLoader;
+
+static void io_loader_free(IoLoader* ld)
+{
+    tree_mem_free(ld->map.slots);
+    tree_mem_free(ld->ids);
+    tree_mem_free(ld->fields);
+    tree_mem_free(ld->labels);
+    tree_mem_free(ld->parent);
+    tree_mem_free(ld->seq);
+    tree_mem_free(ld->text);
+}
+
+/*
+ * ȫ벢 max_nodes = Ͻ * per_line 飻with_rows ʾҪǩС
+ * 뻺ڶʱԤƣڷǰ飬Ԥʱٷ䡣
+ */
+static int io_loader_init(IoLoader* ld, FILE* fp, size_t per_line, int with_rows)
+{
+    memset(ld, 0, sizeof(*ld));
+    size_t budget = tree_get_memory_budget();
+    ld->text = io_read_all(fp, budget, &ld->len, &ld->used);
+    if (!ld->text)
+    {
+        return 0;
+    }
+
+    size_t max_nodes = io_count_lines(ld->text, ld->len) * per_line;
+    size_t per_node = sizeof(IoField) + sizeof(size_t) + (with_rows ? 2 * sizeof(IoField) : sizeof(size_t));
+    size_t array_bytes = max_nodes * per_node + io_map_capacity(max_nodes) * sizeof(size_t);
+    if (!io_within_budget(budget, ld->used, array_bytes))
+    {
+        return 0;
+    }
+    ld->used += array_bytes;
+    ld->ids = (IoField*)tree_mem_alloc(sizeof(IoField) * max_nodes);
+    ld->parent = (size_t*)tree_mem_alloc(sizeof(size_t) * max_nodes);
+    if (with_rows)
+    {
+        ld->fields = (IoField*)tree_mem_alloc(sizeof(IoField) * max_nodes);
+        ld->labels = (IoField*)tree_mem_alloc(sizeof(IoField) * max_nodes);
+    }
+    else
+    {
+        ld->seq = (size_t*)tree_mem_alloc(sizeof(size_t) * max_nodes);
+    }
+    return ld->ids && ld->parent && (with_rows ? (ld->fields && ld->labels) : ld->seq != NULL) &&
+        io_map_init(&ld->map, max_nodes, ld->text, ld->ids);
+}
+
+/* ڵзȫֶΣٷǼǱšţڵԳں֮󣩣ɹ 1 */
+static int io_parse_parent_array(IoLoader* ld)
+{
+    const char* text = ld->text;
+    size_t pos = 0;
+    size_t begin;
+    size_t end;
+    while (io_next_line(text, ld->len, &pos, &begin, &end))
+    {
+        size_t n = ld->n;
+        size_t p = begin;
+        if (!io_next_field(text, &p, end, &ld->ids[n]))
+        {
+            continue; /*  */
+        }
+        if (!io_next_field(text, &p, end, &ld->fields[n]))
+        {
+            return 0;
+        }
+
+        /* ǩΪಿ֣ȥ˿հ */
+        while (p < end && io_is_blank(text[p]))
+        {
+            p++;
+        }
+        while (end > p && io_is_blank(text[end - 1]))
+        {
+            end--;
+        }
+        if (p == end)
+        {
+            return 0;
+        }
+        ld->labels[n].off = p;
+        ld->labels[n].len = end - p;
+        ld->n++;
+    }
+
+    size_t hashes[IO_BATCH];
+    for (size_t base = 0; base < ld->n; base += IO_BATCH)
+    {
+        size_t count = (ld->n - base < IO_BATCH) ? ld->n - base : IO_BATCH;
+        io_map_prepare(&ld->map, ld->ids + base, count, hashes);
+        for (size_t k = 0; k < count; ++k)
+        {
+            if (io_map_find_or_insert(&ld->map, ld->ids[base + k], hashes[k], base + k) != base + k)
+            {
+                return 0; /* ظ */
+            }
+        }
+    }
+
+    for (size_t base = 0; base < ld->n; base += IO_BATCH)
+    {
+        size_t count = (ld->n - base < IO_BATCH) ? ld->n - base : IO_BATCH;
+        io_map_prepare(&ld->map, ld->fields + base, count, hashes);
+        for (size_t k = 0; k < count; ++k)
+        {
+            size_t i = base + k;
+            if (io_is_root_marker(text + ld->fields[i].off, ld->fields[i].len))
+            {
+                ld->parent[i] = IO_NONE;
+                continue;
+            }
+            ld->parent[i] = io_map_find_or_insert(&ld->map, ld->fields[i], hashes[k], IO_NONE);
+            if (ld->parent[i] == IO_NONE)
+            {
+                return 0; /* δ */
+            }
+        }
+    }
+    return ld->n > 0;
+}
+
+/*
+ * ߱ÿз IO_BATCH вԤȡȫŵĲλٰ˳
+ * ڵ㰴״γֱţ¼ڵߵ˳Ѹ seq ĩβɹ 1
+ */
+static int io_parse_edge_list(IoLoader* ld)
+{
+    const char* text = ld->text;
+    IoField keys[IO_BATCH * 2];
+    size_t hashes[IO_BATCH * 2];
+    int fields[IO_BATCH];
+    size_t edges = 0;
+    size_t pos = 0;
+    size_t begin;
+    size_t end;
+    for (;;)
+    {
+        size_t lines = 0;
+        size_t nkeys = 0;
+        while (lines < IO_BATCH && io_next_line(text, ld->len, &pos, &begin, &end))
+        {
+            IoField extra;
+            size_t p = begin;
+            int count = 0;
+            while (count < 2 && io_next_field(text, &p, end, &keys[nkeys + count]))
+            {
+                count++;
+            }
+            if (count == 0)
+            {
+                continue; /*  */
+            }
+            if (io_next_field(text, &p, end, &extra))
+            {
+                return 0;
+            }
+            fields[lines++] = count;
+            nkeys += (size_t)count;
+        }
+        if (lines == 0)
+        {
+            break;
+        }
+
+        io_map_prepare(&ld->map, keys, nkeys, hashes);
+        size_t k = 0;
+        for (size_t l = 0; l < lines; ++l)
+        {
+            size_t idx[2];
+            for (int f = 0; f < fields[l]; ++f, ++k)
+            {
+                ld->ids[ld->n] = keys[k];
+                idx[f] = io_map_find_or_insert(&ld->map, keys[k], hashes[k], ld->n);
+                if (idx[f] == ld->n)
+                {
+                    ld->parent[ld->n++] = IO_NONE;
+                }
+            }
+
+            if (fields[l] == 2)
+            {
+                /* Իڶڵ㶼 */
+                if (idx[0] == idx[1] || ld->parent[idx[1]] != IO_NONE)
+                {
+                    return 0;
+                }
+                ld->parent[idx[1]] = idx[0];
+                ld->seq[edges++] = idx[1];
+            }
+        }
+    }
+
+    /* Ӱߵ˳򣬸״γֵ˳ÿڵǡóһ */
+    for (size_t i = 0; i < ld->n; ++i)
+    {
+        if (ld->parent[i] == IO_NONE)
+        {
+            ld->seq[edges++] = i;
+        }
+    }
+    return ld->n > 0;
+}
+
+TreeNode* tree_create_from_parent_array(FILE* fp)
+{
+    if (!fp)
+    {
+        return NULL;
+    }
+
+    IoLoader ld;
+    TreeNode* root = NULL;
+    if (io_loader_init(&ld, fp, 1, 1) && io_parse_parent_array(&ld))
+    {
+        root = io_build_block(ld.n, ld.parent, NULL, ld.text, ld.labels, ld.used);
+    }
+    io_loader_free(&ld);
+    return root;
+}
+
+TreeNode* tree_create_from_edge_list(FILE* fp)
+{
+    if (!fp)
+    {
+        return NULL;
+    }
+
+    /* ÿ½ڵ */
+    IoLoader ld;
+    TreeNode* root = NULL;
+    if (io_loader_init(&ld, fp, 2, 0) && io_parse_edge_list(&ld))
+    {
+        root = io_build_block(ld.n, ld.parent, ld.seq, ld.text, ld.ids, ld.used);
+    }
+    io_loader_free(&ld);
+    return root;
+}
+
+/* ---------------- д ---------------- */
+
+/* ŵһ fwriteд */
+typedef struct IoWriter
+{
+    FILE* fp;
+    char* buf;
+    size_t len;
+    int failed;
+} IoWriter;
+
+static int io_writer_init(IoWriter* w, FILE* fp)
+{
+    w->fp = fp;
+    w->len = 0;
+    w->failed = 0;
+    w->buf = (char*)tree_mem_alloc(IO_WRITE_BUFFER);
+    return w->buf != NULL;
+}
+
+static void io_flush(IoWriter* w)
+{
+    if (w->len > 0 && !w->failed && fwrite(w->buf, 1, w->len, w->fp) != w->len)
+    {
+        w->failed = 1;
+    }
+    w->len = 0;
+}
+
+/* дʣݲͷŻ壻ok Ϊ 0 ʾ;ʧܡɹ 0 */
+static int io_writer_finish(IoWriter* w, int ok)
+{
+    io_flush(w);
+    tree_mem_free(w->buf);
+    if (fflush(w->fp) != 0)
+    {
+        w->failed = 1;
+    }
+    return (ok && !w->failed) ? 0 : -1;
+}
+
+static void io_write(IoWriter* w, const char* s, size_t n)
+{
+    if (IO_WRITE_BUFFER - w->len < n)
+    {
+        io_flush(w);
+        if (n >= IO_WRITE_BUFFER)
+        {
+            if (!w->failed && fwrite(s, 1, n, w->fp) != n)
+            {
+                w->failed = 1;
+            }
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+/* ֤ٻ n ֽڣn ԶСڻдλãдɵ len */
+static char* io_reserve(IoWriter* w, size_t n)
+{
+    if (IO_WRITE_BUFFER - w->len < n)
+    {
+        io_flush(w);
+    }
+    return w->buf + w->len;
+}
+
+static const char io_digits[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+/*  v ʮд out 20 ֽڣÿγ 100 õλֽ */
+static size_t io_format_size(char* out, size_t v)
+{
+    char tmp[24];
+    size_t i = sizeof(tmp);
+    while (v >= 100)
+    {
+        size_t r = (v % 100) * 2;
+        v /= 100;
+        tmp[--i] = io_digits[r + 1];
+        tmp[--i] = io_digits[r];
+    }
+    if (v >= 10)
+    {
+        tmp[--i] = io_digits[v * 2 + 1];
+        tmp[--i] = io_digits[v * 2];
+    }
+    else
+    {
+        tmp[--i] = (char)('0' + v);
+    }
+    memcpy(out, tmp + i, sizeof(tmp) - i);
+    return sizeof(tmp) - i;
+}
+
+/* Ż -1 */
+static size_t io_format_index(char* out, size_t v)
+{
+    if (v == IO_NONE)
+    {
+        out[0] = '-';
+        out[1] = '1';
+        return 2;
+    }
+    return io_format_size(out, v);
+}
+
+/*
+ * дŵַJSON תšбȫַ
+ * DOTdot Ϊ 1ֻתšбܺͻУֽԭҪתƬθơ
+ */
+static void io_write_quoted(IoWriter* w, const char* s, int dot)
+{
+    static const char hex[] = "0123456789abcdef";
+    io_write(w, "\"", 1);
+    if (!s)
+    {
+        s = "";
+    }
+
+    const char* run = s;
+    const char* p = s;
+    for (; *p; ++p)
+    {
+        unsigned char c = (unsigned char)*p;
+        if (c != '"' && c != '\\' && (c >= 0x20 || (dot && c != '\n')))
+        {
+            continue;
+        }
+
+        io_write(w, run, (size_t)(p - run));
+        run = p + 1;
+        char esc[6] = { '\\', (char)c, 0, 0, 0, 0 };
+        size_t n = 2;
+        if (c == '\n')
+        {
+            esc[1] = 'n';
+        }
+        else if (c == '\t')
+        {
+            esc[1] = 't';
+        }
+        else if (c == '\r')
+        {
+            esc[1] = 'r';
+        }
+        else if (c < 0x20)
+        {
+            esc[1] = 'u';
+            esc[2] = '0';
+            esc[3] = '0';
+            esc[4] = hex[c >> 4];
+            esc[5] = hex[c & 15];
+            n = 6;
+        }
+        io_write(w, esc, n);
+    }
+    io_write(w, run, (size_t)(p - run));
+    io_write(w, "\"", 1);
+}
+
+/*
+ * αţΪ 0..roots-1ʵкӵĽڵʱ next_id ĺš
+ *  TREE_DEFINE_LEVEL_ORDER ķ˳һ£ԷʱдӺֵܵıš
+ */
+typedef struct IoLevelWriter
+{
+    IoWriter out;
+    size_t id;        /* ǰڵı */
+    size_t next_id;   /* һδı */
+} IoLevelWriter;
+
+static void io_level_writer_begin(IoLevelWriter* lw, const TreeNode* root)
+{
+    lw->id = 0;
+    lw->next_id = 0;
+    for (const TreeNode* r = root; r; r = r->next_sibling)
+    {
+        lw->next_id++;
+    }
+}
+
+/* Ϊ node ĺӷţصһӵıţûкʱΪ IO_NONE뺢 */
+static size_t io_level_assign_children(IoLevelWriter* lw, const TreeNode* node, size_t* count)
+{
+    *count = 0;
+    for (const TreeNode* c = node->first_child; c; c = c->next_sibling)
+    {
+        (*count)++;
+    }
+    if (*count == 0)
+    {
+        return IO_NONE;
+    }
+    size_t first = lw->next_id;
+    lw->next_id += *count;
+    return first;
+}
+
+static void io_index_line(IoLevelWriter* lw, const TreeNode* node)
+{
+    size_t count;
+    size_t child = io_level_assign_children(lw, node, &count);
+    size_t sibling = node->next_sibling ? lw->id + 1 : IO_NONE;
+    size_t len = strlen(node->data);
+
+    /* Ѽ IO_INDEX_DATA_MAX ֽ */
+    char* p = io_reserve(&lw->out, IO_INDEX_DATA_MAX + 48);
+    char* start = p;
+    memcpy(p, node->data, len);
+    p += len;
+    *p++ = ' ';
+    p += io_format_index(p, child);
+    *p++ = ' ';
+    p += io_format_index(p, sibling);
+    *p++ = '\n';
+    lw->out.len += (size_t)(p - start);
+    lw->id++;
+}
+
+static void io_dot_node(IoLevelWriter* lw, const TreeNode* node)
+{
+    size_t count;
+    size_t child = io_level_assign_children(lw, node, &count);
+
+    char* p = io_reserve(&lw->out, 32);
+    memcpy(p, "  n", 3);
+    size_t n = 3 + io_format_size(p + 3, lw->id);
+    memcpy(p + n, " [label=", 8);
+    lw->out.len += n + 8;
+    io_write_quoted(&lw->out, node->data, 1);
+    io_write(&lw->out, "];\n", 3);
+
+    for (size_t k = 0; k < count; ++k)
+    {
+        p = io_reserve(&lw->out, 64);
+        memcpy(p, "  n", 3);
+        n = 3 + io_format_size(p + 3, lw->id);
+        memcpy(p + n, " -> n", 5);
+        n += 5;
+        n += io_format_size(p + n, child + k);
+        memcpy(p + n, ";\n", 2);
+        lw->out.len += n + 2;
+    }
+    lw->id++;
+}
+
+TREE_DEFINE_LEVEL_ORDER(io_write_index_nodes, IoLevelWriter*, io_index_line(ctx, node);)
+TREE_DEFINE_LEVEL_ORDER(io_write_dot_nodes, IoLevelWriter*, io_dot_node(ctx, node);)
+
+/* д index ʽǰļ飺ڵԼǷ buildTreeFromFile  */
+typedef struct IoIndexCheck
+{
+    size_t count;
+    int bad;
+} IoIndexCheck;
+
+static void io_index_check(IoIndexCheck* chk, const TreeNode* node)
+{
+    chk->count++;
+    const char* s = node->data;
+    if (!s || *s == '\0')
+    {
+        chk->bad = 1;
+        return;
+    }
+    size_t len = 0;
+    for (; s[len]; ++len)
+    {
+        unsigned char c = (unsigned char)s[len];
+        if (c == ' ' || (c >= '\t' && c <= '\r'))
+        {
+            chk->bad = 1;
+            return;
+        }
+    }
+    if (len > IO_INDEX_DATA_MAX)
+    {
+        chk->bad = 1;
+    }
+}
+
+TREE_DEFINE_PREORDER(io_check_index_nodes, IoIndexCheck*, io_index_check(ctx, node);)
+
+int tree_write_index(const TreeNode* root, FILE* fp)
+{
+    if (!root || !fp)
+    {
+        return -1;
+    }
+
+    IoIndexCheck chk = { 0, 0 };
+    if (io_check_index_nodes(root, &chk) != 0 || chk.bad || chk.count > (size_t)INT_MAX)
+    {
+        return -1;
+    }
+
+    IoLevelWriter lw;
+    if (!io_writer_init(&lw.out, fp))
+    {
+        return -1;
+    }
+    io_level_writer_begin(&lw, root);
+
+    char* p = io_reserve(&lw.out, 32);
+    size_t n = io_format_size(p, chk.count);
+    p[n] = '\n';
+    lw.out.len += n + 1;
+
+    int ok = io_write_index_nodes(root, &lw) == 0;
+    return io_writer_finish(&lw.out, ok);
+}
+
+int tree_write_dot(const TreeNode* root, FILE* fp)
+{
+    if (!root || !fp)
+    {
+        return -1;
+    }
+
+    IoLevelWriter lw;
+    if (!io_writer_init(&lw.out, fp))
+    {
+        return -1;
+    }
+    io_level_writer_begin(&lw, root);
+
+    static const char header[] = "digraph tree {\n";
+    io_write(&lw.out, header, sizeof(header) - 1);
+    int ok = io_write_dot_nodes(root, &lw) == 0;
+    io_write(&lw.out, "}\n", 2);
+    return io_writer_finish(&lw.out, ok);
+}
+
+/*
+ * JSON Ҫ뿪¼ջڵʱдͷкѹջ½
+ * ûֵʱջ "]}"
+ */
+int tree_write_json(const TreeNode* root, FILE* fp)
+{
+    if (!root || !fp)
+    {
+        return -1;
+    }
+
+    IoWriter w;
+    if (!io_writer_init(&w, fp))
+    {
+        return -1;
+    }
+
+    const TreeNode* local[TREE_TRAVERSE_LOCAL];
+    const TreeNode** stack = local;
+    size_t cap = TREE_TRAVERSE_LOCAL;
+    size_t sp = 0;
+    int forest = root->next_sibling != NULL;
+    int ok = 1;
+
+    if (forest)
+    {
+        io_write(&w, "[", 1);
+    }
+
+    const TreeNode* node = root;
+    while (node)
+    {
+        static const char open[] = "{\"label\":";
+        static const char children[] = ",\"children\":[";
+        io_write(&w, open, sizeof(open) - 1);
+        io_write_quoted(&w, node->data, 0);
+
+        if (node->first_child)
+        {
+            if (sp >= cap)
+            {
+                const TreeNode** ns = (const TreeNode**)tree_traverse_grow((void*)stack, local, &cap, sizeof(*stack), sp);
+                if (!ns)
+                {
+                    ok = 0;
+                    break;
+                }
+                stack = ns;
+            }
+            io_write(&w, children, sizeof(children) - 1);
+            stack[sp++] = node;
+            node = node->first_child;
+            continue;
+        }
+
+        io_write(&w, "}", 1);
+        while (!node->next_sibling && sp > 0)
+        {
+            node = stack[--sp];
+            io_write(&w, "]}", 2);
+        }
+        if (node->next_sibling)
+        {
+            io_write(&w, ",", 1);
+        }
+        node = node->next_sibling;
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free((void*)stack);
+    }
+    if (forest)
+    {
+        io_write(&w, "]", 1);
+    }
+    io_write(&w, "\n", 1);
+    return io_writer_finish(&w, ok);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef TREE_IO_H
+#define TREE_IO_H
+
+#include <stdio.h>
+#include "tree.h"
+
+/*
+ * ϵͳõĲεʽڴ棬
+ * ɢбַӳΪڵţٰڵȶļ-ֵӣ
+ * Ϊ O(n)ͬһڵĺӡԼĸеȺ˳
+ * жʱõһƬɭ֣Ϊֵܣ
+ *  tree_create_from_stream һһڴ棨ڵ㰴˳ţһǰ
+ *  tree_free_block ͷţʽ󡢱ظδ塢ڻڴԤʱ NULL
+ * Ԥ㰴ڼķֵ㣨뻺塢ɢбҲ룩ʱͿʼ顣
+ * ֶ֮ÿոƱָбԣĩ '\r' ȥ
+ */
+
+/*
+ * ڵÿ "  ǩ"Ϊ "-1"  "-" ʾ
+ * ⲻհ׵ַڵԳں֮󣻱ǩΪಿ֣ɺո񣩡
+ */
+TreeNode* tree_create_from_parent_array(FILE* fp);
+
+/*
+ * ߱ÿ " ӱ" ʾһߣֻһŵһڵ㡣
+ * ڵǩţÿڵһڵ㣬ûиڵİ״γֵ˳Ϊ
+ */
+TreeNode* tree_create_from_edge_list(FILE* fp);
+
+/*
+ * дƬɭ֣root ֵܣԷǵݹ鷽ʽȫ
+ * д 1MB  fwriteʱ fflushر fp
+ * ɹ 0root Ϊ NULLдʧܻڴ治ʱ -1ʱܲ
+ */
+
+/*
+ * buildTreeFromFile ʽнڵÿС ӱ ֵܱš-1 ʾûУ
+ * Ű˳򣬸Ϊ 01ͬһڵĺӱ
+ * ȱһݣнڵΪահ׻򳬹 255 ֽʱʲôҲд -1
+ */
+int tree_write_index(const TreeNode* root, FILE* fp);
+
+/* Graphviz DOTһ digraphڵΪα n0n1label Ϊڵ */
+int tree_write_dot(const TreeNode* root, FILE* fp);
+
+/*
+ * Ƕ JSONÿڵΪ {"label":"","children":[...]}Ҷʡ children
+ * ֻһʱöɭ顣ֽԭֻתšбַ
+ */
+int tree_write_json(const TreeNode* root, FILE* fp);
+
+#endif /* TREE_IO_H */
@@ -0,0 +1,1897 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#define _CRT_SECURE_NO_WARNINGS
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tree_server.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "tree.h"
+#include "tree_snapshot.h"
+#include "tree_thread.h"
+#include "tree_traverse.h"
+
+#define CONN_READ_CHUNK 65536
+#define CONN_IN_MAX (4u << 20)   /* δ󳬹ֵʱͣȡ */
+#define CONN_OUT_HIGH (4u << 20) /* ͵Ӧֵʱͣɷµһ */
+
+static uint32_t get_u32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t get_u64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void put_u32(char* p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static void put_u64(char* p, uint64_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/* ֽڻ */
+typedef struct Buf
+{
+    char* data;
+    size_t len;
+    size_t cap;
+} Buf;
+
+/* ֤ٻ extra ֽڿУʧܷ -1 */
+static int buf_reserve(Buf* b, size_t extra)
+{
+    if (b->cap - b->len >= extra)
+    {
+        return 0;
+    }
+
+    size_t newcap = b->cap ? b->cap : 4096;
+    while (newcap - b->len < extra)
+    {
+        newcap *= 2;
+    }
+
+    char* nd = (char*)tree_mem_realloc(b->data, newcap);
+    if (!nd)
+    {
+        return -1;
+    }
+    b->data = nd;
+    b->cap = newcap;
+    return 0;
+}
+
+/* ---------------- ÿնӦĲѯ ---------------- */
+
+/*
+ * ɭŵƽ飬ѯΪ O(1)
+ * ǩָеַͬһһա
+ */
+
+#define INDEX_RMQ_BLOCK 32 /* СֵѯĿСֱɨ裬ϡ */
+
+typedef struct ServerIndex
+{
+    uint32_t count;
+    uint32_t roots;
+    uint32_t max_degree;
+    uint32_t depth;
+    uint64_t leaves;
+    const char** label;
+    uint32_t* parent;
+    uint32_t* level;
+    uint32_t* size;
+    uint32_t* height;
+    uint32_t* degree;
+    /* ͬǩĽڵΪһ飬FIND ֻһιϣң members һ */
+    uint32_t* members;     /* еĽڵţڰ */
+    uint32_t* group_start; /*  members е */
+    uint32_t* group_count;
+    uint32_t* group_next;  /* ͬһϣͰеһ */
+    uint32_t* bucket;      /* ÿͰĵһ */
+    uint32_t bucket_mask;
+    /*
+     * ȣu < v ʱ (u, v] вСĽڵ LCA ĺӣͬһʱǸ
+     * rmq[k * rmq_blocks + i] Ϊ i..i+2^k-1 вСĽڵš
+     */
+    uint32_t* rmq;
+    uint32_t rmq_blocks;
+} ServerIndex;
+
+typedef struct IndexFrame
+{
+    const TreeNode* cur; /* һŵĺ */
+    uint32_t id;
+} IndexFrame;
+
+static uint32_t label_hash(const char* s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* ڵȫʧܷ -1 */
+static int index_count(const TreeNode* root, size_t* out)
+{
+    const TreeNode* local[128];
+    const TreeNode** stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+    size_t n = 0;
+
+    if (root)
+    {
+        stack[sp++] = root;
+    }
+    while (sp > 0)
+    {
+        const TreeNode* node = stack[--sp];
+        n++;
+        if (sp + 2 > cap)
+        {
+            const TreeNode** ns = (const TreeNode**)tree_traverse_grow((void*)stack, local, &cap, sizeof(*stack), sp);
+            if (!ns)
+            {
+                if (stack != local)
+                {
+                    tree_mem_free((void*)stack);
+                }
+                return -1;
+            }
+            stack = ns;
+        }
+        if (node->next_sibling)
+        {
+            stack[sp++] = node->next_sibling;
+        }
+        if (node->first_child)
+        {
+            stack[sp++] = node->first_child;
+        }
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free((void*)stack);
+    }
+    *out = n;
+    return 0;
+}
+
+/* ұǩӦ飬ڷ TREE_NO_NODE */
+static uint32_t index_find_group(const ServerIndex* idx, const char* s, size_t len, uint32_t h)
+{
+    for (uint32_t g = idx->bucket[h & idx->bucket_mask]; g != TREE_NO_NODE; g = idx->group_next[g])
+    {
+        const char* rep = idx->label[idx->members[idx->group_start[g]]];
+        if (strncmp(rep, s, len) == 0 && rep[len] == '\0')
+        {
+            return g;
+        }
+    }
+    return TREE_NO_NODE;
+}
+
+/*
+ * ǩ飺һ齨鲢ڵһڵݴ members[] Ϊ
+ * ǰ׺ȷ㣬ڶ鰴ѽڵԵ顣
+ */
+static int index_group_labels(ServerIndex* idx)
+{
+    uint32_t n = idx->count;
+    uint32_t* group_of = (uint32_t*)tree_mem_alloc(sizeof(uint32_t) * (size_t)n * 2);
+    if (!group_of)
+    {
+        return -1;
+    }
+    uint32_t* cursor = group_of + n;
+
+    memset(idx->bucket, 0xFF, sizeof(uint32_t) * ((size_t)idx->bucket_mask + 1));
+    uint32_t groups = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const char* s = idx->label[i];
+        size_t len = strlen(s);
+        uint32_t h = label_hash(s, len);
+        uint32_t g;
+        for (g = idx->bucket[h & idx->bucket_mask]; g != TREE_NO_NODE; g = idx->group_next[g])
+        {
+            if (strcmp(idx->label[idx->members[g]], s) == 0)
+            {
+                break;
+            }
+        }
+        if (g == TREE_NO_NODE)
+        {
+            g = groups++;
+            idx->members[g] = i;
+            idx->group_count[g] = 0;
+            idx->group_next[g] = idx->bucket[h & idx->bucket_mask];
+            idx->bucket[h & idx->bucket_mask] = g;
+        }
+        idx->group_count[g]++;
+        group_of[i] = g;
+    }
+
+    uint32_t start = 0;
+    for (uint32_t g = 0; g < groups; ++g)
+    {
+        idx->group_start[g] = start;
+        cursor[g] = start;
+        start += idx->group_count[g];
+    }
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        idx->members[cursor[group_of[i]]++] = i;
+    }
+
+    tree_mem_free(group_of);
+    return 0;
+}
+
+/*  [lo, hi]  level СĽڵ㣨Ƚϣ */
+static uint32_t index_scan_min(const ServerIndex* idx, uint32_t lo, uint32_t hi, uint32_t best)
+{
+    for (uint32_t i = lo; i <= hi; ++i)
+    {
+        if (idx->level[i] < idx->level[best])
+        {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/* ϡ 0 ΪСֵ k ϲ k-1  2^(k-1)  */
+static void index_build_rmq(ServerIndex* idx, size_t levels)
+{
+    uint32_t blocks = idx->rmq_blocks;
+    for (uint32_t b = 0; b < blocks; ++b)
+    {
+        uint32_t lo = b * INDEX_RMQ_BLOCK;
+        uint32_t hi = (b + 1 < blocks) ? lo + INDEX_RMQ_BLOCK - 1 : idx->count - 1;
+        idx->rmq[b] = index_scan_min(idx, lo + 1, hi, lo);
+    }
+    for (size_t k = 1; k < levels; ++k)
+    {
+        const uint32_t* prev = idx->rmq + (k - 1) * blocks;
+        uint32_t* cur = idx->rmq + k * blocks;
+        uint32_t half = (uint32_t)1 << (k - 1);
+        for (uint32_t b = 0; b + 2 * half <= blocks; ++b)
+        {
+            uint32_t x = prev[b];
+            uint32_t y = prev[b + half];
+            cur[b] = (idx->level[y] < idx->level[x]) ? y : x;
+        }
+    }
+}
+
+/*  [lo, hi] ڲСĽڵ㣺˲Ŀֱɨ裬мϡ */
+static uint32_t index_min_level(const ServerIndex* idx, uint32_t lo, uint32_t hi)
+{
+    uint32_t bl = lo / INDEX_RMQ_BLOCK;
+    uint32_t bh = hi / INDEX_RMQ_BLOCK;
+    if (bl == bh)
+    {
+        return index_scan_min(idx, lo + 1, hi, lo);
+    }
+
+    uint32_t best = index_scan_min(idx, lo + 1, (bl + 1) * INDEX_RMQ_BLOCK - 1, lo);
+    best = index_scan_min(idx, bh * INDEX_RMQ_BLOCK, hi, best);
+    if (bl + 1 < bh)
+    {
+        uint32_t span = bh - bl - 1;
+        uint32_t k = 0;
+        while ((2u << k) <= span)
+        {
+            k++;
+        }
+        const uint32_t* row = idx->rmq + (size_t)k * idx->rmq_blocks;
+        uint32_t x = row[bl + 1];
+        uint32_t y = row[bh - (1u << k)];
+        if (idx->level[y] < idx->level[x])
+        {
+            x = y;
+        }
+        if (idx->level[x] < idx->level[best])
+        {
+            best = x;
+        }
+    }
+    return best;
+}
+
+static ServerIndex* index_build(const TreeNode* root)
+{
+    size_t n;
+    if (index_count(root, &n) != 0 || n == 0 || n >= TREE_NO_NODE)
+    {
+        return NULL;
+    }
+
+    size_t buckets = 16;
+    while (buckets < n * 2)
+    {
+        buckets *= 2;
+    }
+
+    size_t blocks = (n + INDEX_RMQ_BLOCK - 1) / INDEX_RMQ_BLOCK;
+    size_t rmq_levels = 1;
+    while (((size_t)2 << (rmq_levels - 1)) <= blocks)
+    {
+        rmq_levels++;
+    }
+
+    /* һηָǰԱ֤ */
+    size_t per_node = sizeof(const char*) + 9 * sizeof(uint32_t);
+    size_t tail = (buckets + blocks * rmq_levels) * sizeof(uint32_t);
+    if (n > ((size_t)-1 - sizeof(ServerIndex) - tail) / per_node)
+    {
+        return NULL;
+    }
+    ServerIndex* idx = (ServerIndex*)tree_mem_alloc(sizeof(ServerIndex) + n * per_node + tail);
+    if (!idx)
+    {
+        return NULL;
+    }
+
+    idx->label = (const char**)(idx + 1);
+    idx->parent = (uint32_t*)(idx->label + n);
+    idx->level = idx->parent + n;
+    idx->size = idx->level + n;
+    idx->height = idx->size + n;
+    idx->degree = idx->height + n;
+    idx->members = idx->degree + n;
+    idx->group_start = idx->members + n;
+    idx->group_count = idx->group_start + n;
+    idx->group_next = idx->group_count + n;
+    idx->bucket = idx->group_next + n;
+    idx->bucket_mask = (uint32_t)(buckets - 1);
+    idx->rmq = idx->bucket + buckets;
+    idx->rmq_blocks = (uint32_t)blocks;
+    idx->count = (uint32_t)n;
+    idx->roots = 0;
+    idx->max_degree = 0;
+    idx->depth = 0;
+    idx->leaves = 0;
+
+    IndexFrame local[128];
+    IndexFrame* stack = local;
+    size_t cap = sizeof(local) / sizeof(local[0]);
+    size_t sp = 0;
+    uint32_t next = 0;
+
+    stack[sp].cur = root; /* ײ֡亢Ϊֵ */
+    stack[sp].id = TREE_NO_NODE;
+    sp++;
+
+    while (sp > 0)
+    {
+        IndexFrame* f = &stack[sp - 1];
+        if (f->cur)
+        {
+            const TreeNode* c = f->cur;
+            uint32_t pid = f->id;
+            uint32_t id = next++;
+            f->cur = c->next_sibling;
+
+            idx->label[id] = c->data ? c->data : "";
+            idx->parent[id] = pid;
+            idx->level[id] = (uint32_t)sp; /* ֡ռ 1 㣬ĲΪ 1 */
+            idx->size[id] = 1;
+            idx->height[id] = 1;
+            idx->degree[id] = 0;
+            if (pid != TREE_NO_NODE)
+            {
+                idx->degree[pid]++;
+            }
+            else
+            {
+                idx->roots++;
+            }
+
+            if (sp >= cap)
+            {
+                IndexFrame* ns = (IndexFrame*)tree_traverse_grow(stack, local, &cap, sizeof(IndexFrame), sp);
+                if (!ns)
+                {
+                    if (stack != local)
+                    {
+                        tree_mem_free(stack);
+                    }
+                    tree_mem_free(idx);
+                    return NULL;
+                }
+                stack = ns;
+            }
+            stack[sp].cur = c->first_child;
+            stack[sp].id = id;
+            sp++;
+            continue;
+        }
+
+        uint32_t id = f->id;
+        sp--;
+        if (id == TREE_NO_NODE)
+        {
+            break;
+        }
+
+        /* ȫɣѴС͸߶Ȼܵڵ */
+        if (idx->degree[id] == 0)
+        {
+            idx->leaves++;
+        }
+        if (idx->degree[id] > idx->max_degree)
+        {
+            idx->max_degree = idx->degree[id];
+        }
+        uint32_t p = idx->parent[id];
+        if (p != TREE_NO_NODE)
+        {
+            idx->size[p] += idx->size[id];
+            if (idx->height[id] + 1 > idx->height[p])
+            {
+                idx->height[p] = idx->height[id] + 1;
+            }
+        }
+        else if (idx->height[id] > idx->depth)
+        {
+            idx->depth = idx->height[id];
+        }
+    }
+
+    if (stack != local)
+    {
+        tree_mem_free(stack);
+    }
+
+    if (index_group_labels(idx) != 0)
+    {
+        tree_mem_free(idx);
+        return NULL;
+    }
+    index_build_rmq(idx, rmq_levels);
+    return idx;
+}
+
+/* һͷſʱãڹ߳ϣtree_free ǵݹ飬ᱬջ */
+static void index_destroy(TreeNode* root, void* ctx)
+{
+    tree_free(root);
+    tree_mem_free(ctx);
+}
+
+/* ļüΪ 1 Ŀ */
+static TreeSnapshot* load_snapshot(const char* filename)
+{
+    TreeNode* root = buildTreeFromFile(filename);
+    if (!root)
+    {
+        return NULL;
+    }
+
+    ServerIndex* idx = index_build(root);
+    if (!idx)
+    {
+        tree_free(root);
+        return NULL;
+    }
+
+    TreeSnapshot* snap = tree_snapshot_create(root, index_destroy, idx);
+    if (!snap)
+    {
+        index_destroy(root, idx);
+    }
+    return snap;
+}
+
+/* ----------------  ---------------- */
+
+typedef struct ServerConn
+{
+    int fd;
+    uint32_t events;  /* ǰ epoll ע¼ */
+    int busy;         /* һڹ߳ */
+    int eof;          /* Զѹرд򣬷ʣӦر */
+    int dead;         /* ѹرգȴ߳̽ͷ */
+    int failed;       /* ̴߳ʱڴ治 */
+    Buf in;           /* δɷֽڣĩβǰ֡ */
+    Buf out;          /* ͵Ӧ */
+    size_t out_off;
+    Buf batch;        /* ̵߳һ֡ */
+    size_t batch_off; /* һ֡RELOAD ¼̺߳ */
+    Buf resp;         /* ߳дӦ */
+    struct ServerConn* next_job; /*  / ɶ / ͷ */
+    struct ServerConn* prev;
+    struct ServerConn* next;
+} ServerConn;
+
+struct TreeServer
+{
+    char* socket_path;
+    char* filename;
+    int listen_fd;
+    int epoll_fd;
+    int event_fd;    /* ߳һֹͣʱ¼ѭ */
+    int signal_fd;
+    int bound;
+
+    TreeSnapshotSlot* slot;
+
+    tree_thread_t* threads;
+    int thread_count;
+    tree_thread_t reloader;
+    int reloader_started;
+
+    tree_mutex_t lock;
+    tree_cond_t job_cond;
+    ServerConn* jobs;      /*  lock  */
+    ServerConn* jobs_tail; /*  lock  */
+    ServerConn* done;      /*  lock  */
+    int stopping;          /*  lock ֪ͨ߳¼߳˳ */
+    tree_cond_t reload_cond;
+    ServerConn* reloads;   /*  lock ͣ RELOAD ֡ϡȴһμص */
+
+    tree_atomic_t stop;
+
+    ServerConn* conns;     /* ֻ¼ѭ̷߳ */
+    ServerConn* graveyard;
+};
+
+/* Ӧ׷һ֡ͷؽָ룻ڴ治㷵 NULL */
+static char* resp_begin(ServerConn* c, uint32_t id, TreeQueryStatus status, size_t payload)
+{
+    if (buf_reserve(&c->resp, 9 + payload) != 0)
+    {
+        return NULL;
+    }
+
+    char* p = c->resp.data + c->resp.len;
+    put_u32(p, (uint32_t)(5 + payload));
+    put_u32(p + 4, id);
+    p[8] = (char)status;
+    c->resp.len += 9 + payload;
+    return p + 9;
+}
+
+/* һ֡frame ָ򳤶ֶ֮󣩣RELOAD ڴ˴ 1ڴ治㷵 -1 */
+static int serve_frame(const ServerIndex* idx, ServerConn* c, const char* frame, uint32_t len)
+{
+    uint32_t id = get_u32(frame);
+    unsigned op = (unsigned char)frame[4];
+    const char* arg = frame + 5;
+    uint32_t arglen = len - 5;
+    char* p;
+
+    if (!idx)
+    {
+        return resp_begin(c, id, TREE_QUERY_NOT_FOUND, 0) ? 0 : -1;
+    }
+
+    switch (op)
+    {
+    case TREE_OP_STATS:
+        if (arglen != 0)
+        {
+            break;
+        }
+        if (!(p = resp_begin(c, id, TREE_QUERY_OK, 28)))
+        {
+            return -1;
+        }
+        put_u64(p, idx->count);
+        put_u64(p + 8, idx->leaves);
+        put_u32(p + 16, idx->max_degree);
+        put_u32(p + 20, idx->depth);
+        put_u32(p + 24, idx->roots);
+        return 0;
+
+    case TREE_OP_FIND:
+    {
+        /* ǩв '\0' '\0' ĲֱΪûƥ */
+        uint32_t g = TREE_NO_NODE;
+        if (!memchr(arg, 0, arglen))
+        {
+            g = index_find_group(idx, arg, arglen, label_hash(arg, arglen));
+        }
+        uint32_t total = (g != TREE_NO_NODE) ? idx->group_count[g] : 0;
+        uint32_t shown = (total < TREE_FIND_MAX_IDS) ? total : TREE_FIND_MAX_IDS;
+        if (!(p = resp_begin(c, id, TREE_QUERY_OK, 8 + (size_t)shown * 4)))
+        {
+            return -1;
+        }
+        put_u32(p, total);
+        put_u32(p + 4, shown);
+        if (shown > 0)
+        {
+            memcpy(p + 8, idx->members + idx->group_start[g], (size_t)shown * 4);
+        }
+        return 0;
+    }
+
+    case TREE_OP_LEVEL:
+    case TREE_OP_SUBTREE:
+    {
+        if (arglen != 4)
+        {
+            break;
+        }
+        uint32_t node = get_u32(arg);
+        if (node >= idx->count)
+        {
+            return resp_begin(c, id, TREE_QUERY_NOT_FOUND, 0) ? 0 : -1;
+        }
+        if (op == TREE_OP_LEVEL)
+        {
+            if (!(p = resp_begin(c, id, TREE_QUERY_OK, 4)))
+            {
+                return -1;
+            }
+            put_u32(p, idx->level[node]);
+            return 0;
+        }
+        size_t label_len = strlen(idx->label[node]);
+        if (!(p = resp_begin(c, id, TREE_QUERY_OK, 16 + label_len)))
+        {
+            return -1;
+        }
+        put_u32(p, idx->size[node]);
+        put_u32(p + 4, idx->height[node]);
+        put_u32(p + 8, idx->degree[node]);
+        put_u32(p + 12, idx->parent[node]);
+        memcpy(p + 16, idx->label[node], label_len);
+        return 0;
+    }
+
+    case TREE_OP_ANCESTOR:
+    {
+        if (arglen != 8)
+        {
+            break;
+        }
+        uint32_t a = get_u32(arg);
+        uint32_t b = get_u32(arg + 4);
+        if (a >= idx->count || b >= idx->count)
+        {
+            return resp_begin(c, id, TREE_QUERY_NOT_FOUND, 0) ? 0 : -1;
+        }
+
+        /*  a ռ [a, a + size) */
+        int is_ancestor = (b >= a && b - a < idx->size[a]);
+        uint32_t x = a;
+        if (a != b)
+        {
+            uint32_t u = (a < b) ? a : b;
+            uint32_t v = (a < b) ? b : a;
+            x = idx->parent[index_min_level(idx, u + 1, v)];
+        }
+
+        if (!(p = resp_begin(c, id, TREE_QUERY_OK, 5)))
+        {
+            return -1;
+        }
+        p[0] = (char)is_ancestor;
+        put_u32(p + 1, x);
+        return 0;
+    }
+
+    case TREE_OP_RELOAD:
+        if (arglen != 0)
+        {
+            break;
+        }
+        return 1; /*  serve_batch ת¼߳ */
+
+    default:
+        break;
+    }
+
+    return resp_begin(c, id, TREE_QUERY_BAD_REQUEST, 0) ? 0 : -1;
+}
+
+/* ŵĩβһ̣߳߳ lock */
+static void server_push_job(TreeServer* srv, ServerConn* c)
+{
+    c->next_job = NULL;
+    if (srv->jobs_tail)
+    {
+        srv->jobs_tail->next_job = c;
+    }
+    else
+    {
+        srv->jobs = c;
+    }
+    srv->jobs_tail = c;
+    tree_cond_signal(&srv->job_cond);
+}
+
+/*
+ *  batch_off һRELOAD ֮ǰʹͬһգڵĽ˴һ¡
+ *  RELOAD ʱͣڸ֡Ϸ 1¼̻߳شٰŻУ
+ * ꣨ڴ治㣩 0
+ */
+static int serve_batch(TreeServer* srv, ServerConn* c)
+{
+    TreeSnapshot* snap = tree_snapshot_acquire(srv->slot);
+    const ServerIndex* idx = (const ServerIndex*)tree_snapshot_context(snap);
+
+    int parked = 0;
+    size_t off = c->batch_off;
+    while (off < c->batch.len)
+    {
+        uint32_t len = get_u32(c->batch.data + off);
+        int rc = serve_frame(idx, c, c->batch.data + off + 4, len);
+        if (rc > 0)
+        {
+            parked = 1;
+            break;
+        }
+        if (rc != 0)
+        {
+            c->failed = 1;
+            break;
+        }
+        off += 4 + (size_t)len;
+    }
+    if (parked)
+    {
+        c->batch_off = off;
+    }
+    else
+    {
+        c->batch.len = 0;
+        c->batch_off = 0;
+    }
+
+    tree_snapshot_release(snap);
+    return parked;
+}
+
+static TREE_THREAD_PROC(server_worker, arg)
+{
+    TreeServer* srv = (TreeServer*)arg;
+
+    /* źֻ¼ѭͨ signalfd ܱͶݵ߳ */
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    for (;;)
+    {
+        tree_mutex_lock(&srv->lock);
+        while (!srv->jobs && !srv->stopping)
+        {
+            tree_cond_wait(&srv->job_cond, &srv->lock);
+        }
+        ServerConn* c = srv->jobs;
+        if (!c)
+        {
+            tree_mutex_unlock(&srv->lock);
+            break;
+        }
+        srv->jobs = c->next_job;
+        if (!srv->jobs)
+        {
+            srv->jobs_tail = NULL;
+        }
+        tree_mutex_unlock(&srv->lock);
+
+        if (serve_batch(srv, c))
+        {
+            tree_mutex_lock(&srv->lock);
+            c->next_job = srv->reloads;
+            srv->reloads = c;
+            tree_cond_signal(&srv->reload_cond);
+            tree_mutex_unlock(&srv->lock);
+            continue;
+        }
+
+        tree_mutex_lock(&srv->lock);
+        c->next_job = srv->done;
+        srv->done = c;
+        tree_mutex_unlock(&srv->lock);
+
+        uint64_t one = 1;
+        ssize_t ignored = write(srv->event_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    TREE_THREAD_RETURN;
+}
+
+/*
+ * ¼̣߳뽨ռụ̀߳ͬһʱֻһμأصȺ󷢲
+ * ᱻ翪ʼļظǡÿȡȫڵȴ RELOAD һμصĽ
+ * ǶμؿʼǰڼµһΣڴһ
+ */
+static TREE_THREAD_PROC(server_reloader, arg)
+{
+    TreeServer* srv = (TreeServer*)arg;
+
+    sigset_t all;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, NULL);
+
+    for (;;)
+    {
+        tree_mutex_lock(&srv->lock);
+        while (!srv->reloads && !srv->stopping)
+        {
+            tree_cond_wait(&srv->reload_cond, &srv->lock);
+        }
+        if (srv->stopping)
+        {
+            /* ڵȴ tree_server_free һͷ */
+            tree_mutex_unlock(&srv->lock);
+            break;
+        }
+        ServerConn* list = srv->reloads;
+        srv->reloads = NULL;
+        tree_mutex_unlock(&srv->lock);
+
+        TreeSnapshot* snap = load_snapshot(srv->filename);
+        uint64_t count = 0;
+        if (snap)
+        {
+            count = ((const ServerIndex*)tree_snapshot_context(snap))->count;
+            tree_snapshot_publish(srv->slot, snap);
+        }
+
+        int wake = 0;
+        while (list)
+        {
+            ServerConn* c = list;
+            list = c->next_job;
+
+            uint32_t len = get_u32(c->batch.data + c->batch_off);
+            uint32_t id = get_u32(c->batch.data + c->batch_off + 4);
+            char* p = resp_begin(c, id, snap ? TREE_QUERY_OK : TREE_QUERY_FAILED, snap ? 8 : 0);
+            if (!p)
+            {
+                c->failed = 1;
+            }
+            else if (snap)
+            {
+                put_u64(p, count);
+            }
+            c->batch_off += 4 + (size_t)len;
+
+            /*  RELOAD ֮󽻻ع̣߳ʹ */
+            tree_mutex_lock(&srv->lock);
+            if (!c->failed && c->batch_off < c->batch.len)
+            {
+                server_push_job(srv, c);
+            }
+            else
+            {
+                c->batch.len = 0;
+                c->batch_off = 0;
+                c->next_job = srv->done;
+                srv->done = c;
+                wake = 1;
+            }
+            tree_mutex_unlock(&srv->lock);
+        }
+
+        if (wake)
+        {
+            uint64_t one = 1;
+            ssize_t ignored = write(srv->event_fd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+    TREE_THREAD_RETURN;
+}
+
+static void conn_free(TreeServer* srv, ServerConn* c)
+{
+    if (c->prev)
+    {
+        c->prev->next = c->next;
+    }
+    else
+    {
+        srv->conns = c->next;
+    }
+    if (c->next)
+    {
+        c->next->prev = c->prev;
+    }
+    if (c->fd >= 0)
+    {
+        close(c->fd);
+    }
+    tree_mem_free(c->in.data);
+    tree_mem_free(c->out.data);
+    tree_mem_free(c->batch.data);
+    tree_mem_free(c->resp.data);
+    tree_mem_free(c);
+}
+
+/* رӣڹ߳еӵȽͷţڱ¼ͷ */
+static void conn_kill(TreeServer* srv, ServerConn* c)
+{
+    if (c->dead)
+    {
+        return;
+    }
+
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->fd = -1;
+    c->dead = 1;
+    if (!c->busy)
+    {
+        c->next_job = srv->graveyard;
+        srv->graveyard = c;
+    }
+}
+
+static void conn_update_events(TreeServer* srv, ServerConn* c)
+{
+    uint32_t want = 0;
+    if (!c->eof && c->in.len < CONN_IN_MAX)
+    {
+        want |= EPOLLIN;
+    }
+    if (c->out_off < c->out.len)
+    {
+        want |= EPOLLOUT;
+    }
+    if (want != c->events)
+    {
+        struct epoll_event ev;
+        ev.events = want;
+        ev.data.ptr = c;
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->events = want;
+    }
+}
+
+static void conn_flush(TreeServer* srv, ServerConn* c)
+{
+    while (c->out_off < c->out.len)
+    {
+        ssize_t n = send(c->fd, c->out.data + c->out_off, c->out.len - c->out_off, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            c->out_off += (size_t)n;
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        else
+        {
+            conn_kill(srv, c);
+            return;
+        }
+    }
+    c->out_off = 0;
+    c->out.len = 0;
+}
+
+/* 뻺֡Ϊһ߳ */
+static void conn_dispatch(TreeServer* srv, ServerConn* c)
+{
+    size_t off = 0;
+    while (c->in.len - off >= 4)
+    {
+        uint32_t len = get_u32(c->in.data + off);
+        if (len < 5 || len > TREE_FRAME_MAX)
+        {
+            conn_kill(srv, c);
+            return;
+        }
+        if (c->in.len - off - 4 < len)
+        {
+            break;
+        }
+        off += 4 + (size_t)len;
+    }
+    if (off == 0)
+    {
+        return;
+    }
+
+    /* Ǹֻĩβİ֡뻺 */
+    Buf t = c->batch;
+    c->batch = c->in;
+    c->in = t;
+    c->in.len = 0;
+    size_t rest = c->batch.len - off;
+    if (rest > 0)
+    {
+        if (buf_reserve(&c->in, rest) != 0)
+        {
+            conn_kill(srv, c);
+            return;
+        }
+        memcpy(c->in.data, c->batch.data + off, rest);
+        c->in.len = rest;
+    }
+    c->batch.len = off;
+    c->batch_off = 0;
+    c->busy = 1;
+
+    tree_mutex_lock(&srv->lock);
+    server_push_job(srv, c);
+    tree_mutex_unlock(&srv->lock);
+}
+
+/* ״̬仯󣺳ɷһԶѰر¿ʱرգ¹ע¼ */
+static void conn_progress(TreeServer* srv, ServerConn* c)
+{
+    if (c->dead)
+    {
+        return;
+    }
+
+    if (!c->busy && c->out.len - c->out_off < CONN_OUT_HIGH)
+    {
+        conn_dispatch(srv, c);
+        if (c->dead)
+        {
+            return;
+        }
+    }
+
+    if (c->eof && !c->busy && c->out_off == c->out.len)
+    {
+        conn_kill(srv, c);
+        return;
+    }
+    conn_update_events(srv, c);
+}
+
+static void conn_readable(TreeServer* srv, ServerConn* c)
+{
+    while (c->in.len < CONN_IN_MAX)
+    {
+        if (buf_reserve(&c->in, CONN_READ_CHUNK) != 0)
+        {
+            conn_kill(srv, c);
+            return;
+        }
+        ssize_t n = read(c->fd, c->in.data + c->in.len, c->in.cap - c->in.len);
+        if (n > 0)
+        {
+            c->in.len += (size_t)n;
+        }
+        else if (n == 0)
+        {
+            c->eof = 1;
+            break;
+        }
+        else if (errno == EINTR)
+        {
+            continue;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else
+        {
+            conn_kill(srv, c);
+            return;
+        }
+    }
+    conn_progress(srv, c);
+}
+
+static void server_accept(TreeServer* srv)
+{
+    for (;;)
+    {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return; /* EAGAIN ʱ޷ܣļľ */
+        }
+
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        ServerConn* c = (ServerConn*)tree_mem_calloc(1, sizeof(ServerConn));
+        if (!c)
+        {
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->events = EPOLLIN;
+
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = c;
+        if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+        {
+            close(fd);
+            tree_mem_free(c);
+            continue;
+        }
+
+        c->next = srv->conns;
+        if (srv->conns)
+        {
+            srv->conns->prev = c;
+        }
+        srv->conns = c;
+    }
+}
+
+/* ջع̴߳ӣӦ뷢ͻ */
+static void server_collect(TreeServer* srv)
+{
+    uint64_t value;
+    ssize_t ignored = read(srv->event_fd, &value, sizeof(value));
+    (void)ignored;
+
+    tree_mutex_lock(&srv->lock);
+    ServerConn* list = srv->done;
+    srv->done = NULL;
+    tree_mutex_unlock(&srv->lock);
+
+    while (list)
+    {
+        ServerConn* c = list;
+        list = c->next_job;
+        c->busy = 0;
+
+        if (c->dead)
+        {
+            c->next_job = srv->graveyard;
+            srv->graveyard = c;
+            continue;
+        }
+        if (c->failed)
+        {
+            conn_kill(srv, c);
+            continue;
+        }
+
+        if (c->out_off == c->out.len)
+        {
+            Buf t = c->out;
+            c->out = c->resp;
+            c->resp = t;
+            c->out_off = 0;
+        }
+        else
+        {
+            memmove(c->out.data, c->out.data + c->out_off, c->out.len - c->out_off);
+            c->out.len -= c->out_off;
+            c->out_off = 0;
+            if (buf_reserve(&c->out, c->resp.len) != 0)
+            {
+                conn_kill(srv, c);
+                continue;
+            }
+            memcpy(c->out.data + c->out.len, c->resp.data, c->resp.len);
+            c->out.len += c->resp.len;
+        }
+        c->resp.len = 0;
+
+        conn_flush(srv, c);
+        conn_progress(srv, c);
+    }
+}
+
+TreeServer* tree_server_create(const char* socket_path, const char* filename, int workers)
+{
+    if (!socket_path || !filename)
+    {
+        return NULL;
+    }
+
+    struct sockaddr_un addr;
+    size_t path_len = strlen(socket_path);
+    if (path_len == 0 || path_len >= sizeof(addr.sun_path))
+    {
+        return NULL;
+    }
+
+    TreeServer* srv = (TreeServer*)tree_mem_calloc(1, sizeof(TreeServer));
+    if (!srv)
+    {
+        return NULL;
+    }
+    srv->listen_fd = -1;
+    srv->epoll_fd = -1;
+    srv->event_fd = -1;
+    srv->signal_fd = -1;
+    tree_mutex_init(&srv->lock);
+    tree_cond_init(&srv->job_cond);
+    tree_cond_init(&srv->reload_cond);
+
+    size_t file_len = strlen(filename) + 1;
+    srv->socket_path = (char*)tree_mem_alloc(path_len + 1);
+    srv->filename = (char*)tree_mem_alloc(file_len);
+    srv->slot = tree_snapshot_slot_create();
+    if (!srv->socket_path || !srv->filename || !srv->slot)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    memcpy(srv->socket_path, socket_path, path_len + 1);
+    memcpy(srv->filename, filename, file_len);
+
+    TreeSnapshot* snap = load_snapshot(filename);
+    if (!snap)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    tree_snapshot_publish(srv->slot, snap);
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, socket_path, path_len + 1);
+
+    srv->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (srv->listen_fd < 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    fcntl(srv->listen_fd, F_SETFL, fcntl(srv->listen_fd, F_GETFL) | O_NONBLOCK);
+    fcntl(srv->listen_fd, F_SETFD, FD_CLOEXEC);
+
+    unlink(socket_path); /* ϴ쳣˳µ׽ļ */
+    if (bind(srv->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    srv->bound = 1;
+    if (listen(srv->listen_fd, SOMAXCONN) != 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+
+    srv->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    srv->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (srv->epoll_fd < 0 || srv->event_fd < 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &srv->listen_fd;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->listen_fd, &ev) != 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    ev.events = EPOLLIN;
+    ev.data.ptr = &srv->event_fd;
+    if (epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->event_fd, &ev) != 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+
+    if (workers <= 0)
+    {
+        workers = 4;
+    }
+    srv->threads = (tree_thread_t*)tree_mem_alloc(sizeof(tree_thread_t) * (size_t)workers);
+    if (!srv->threads)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    for (int i = 0; i < workers; ++i)
+    {
+        if (tree_thread_start(&srv->threads[i], server_worker, srv) != 0)
+        {
+            tree_server_free(srv);
+            return NULL;
+        }
+        srv->thread_count++;
+    }
+    if (tree_thread_start(&srv->reloader, server_reloader, srv) != 0)
+    {
+        tree_server_free(srv);
+        return NULL;
+    }
+    srv->reloader_started = 1;
+
+    return srv;
+}
+
+int tree_server_run(TreeServer* srv)
+{
+    if (!srv)
+    {
+        return -1;
+    }
+
+    /* SIGINT / SIGTERM ͨ signalfd ¼ѭԱرգ˳ʱָԭź */
+    sigset_t mask;
+    sigset_t old_mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, &old_mask);
+    srv->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (srv->signal_fd >= 0)
+    {
+        struct epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.ptr = &srv->signal_fd;
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_ADD, srv->signal_fd, &ev);
+    }
+
+    int rc = 0;
+    struct epoll_event events[64];
+    while (!tree_atomic_load(&srv->stop))
+    {
+        int n = epoll_wait(srv->epoll_fd, events, (int)(sizeof(events) / sizeof(events[0])), -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            rc = -1;
+            break;
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            void* ptr = events[i].data.ptr;
+            if (ptr == &srv->listen_fd)
+            {
+                server_accept(srv);
+            }
+            else if (ptr == &srv->event_fd)
+            {
+                server_collect(srv);
+            }
+            else if (ptr == &srv->signal_fd)
+            {
+                /* źʹ䲻ٹ𣬷ָźʱᰴĬ϶ֹ */
+                struct signalfd_siginfo info;
+                while (read(srv->signal_fd, &info, sizeof(info)) == (ssize_t)sizeof(info))
+                {
+                }
+                tree_atomic_store(&srv->stop, 1);
+            }
+            else
+            {
+                ServerConn* c = (ServerConn*)ptr;
+                uint32_t got = events[i].events;
+                if (c->dead)
+                {
+                    continue;
+                }
+                if (got & (EPOLLERR | EPOLLHUP))
+                {
+                    conn_kill(srv, c);
+                    continue;
+                }
+                if (got & EPOLLIN)
+                {
+                    conn_readable(srv, c);
+                }
+                if (!c->dead && (got & EPOLLOUT))
+                {
+                    conn_flush(srv, c);
+                    conn_progress(srv, c);
+                }
+            }
+        }
+
+        /* ͬһֵ¼ѹرյӣͳһڱֽͷ */
+        while (srv->graveyard)
+        {
+            ServerConn* c = srv->graveyard;
+            srv->graveyard = c->next_job;
+            conn_free(srv, c);
+        }
+    }
+
+    if (srv->signal_fd >= 0)
+    {
+        epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, srv->signal_fd, NULL);
+        close(srv->signal_fd);
+        srv->signal_fd = -1;
+    }
+    pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+    return rc;
+}
+
+void tree_server_stop(TreeServer* srv)
+{
+    if (srv)
+    {
+        tree_atomic_store(&srv->stop, 1);
+        uint64_t one = 1;
+        ssize_t ignored = write(srv->event_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void tree_server_free(TreeServer* srv)
+{
+    if (!srv)
+    {
+        return;
+    }
+
+    /* ̴߳Ŷӵκ˳¼̲߳ٿʼµļ */
+    tree_mutex_lock(&srv->lock);
+    srv->stopping = 1;
+    tree_cond_broadcast(&srv->job_cond);
+    tree_cond_broadcast(&srv->reload_cond);
+    tree_mutex_unlock(&srv->lock);
+    if (srv->reloader_started)
+    {
+        tree_thread_join(srv->reloader);
+    }
+    for (int i = 0; i < srv->thread_count; ++i)
+    {
+        tree_thread_join(srv->threads[i]);
+    }
+    tree_mem_free(srv->threads);
+
+    while (srv->graveyard)
+    {
+        ServerConn* c = srv->graveyard;
+        srv->graveyard = c->next_job;
+        conn_free(srv, c);
+    }
+    while (srv->conns)
+    {
+        conn_free(srv, srv->conns);
+    }
+
+    if (srv->listen_fd >= 0)
+    {
+        close(srv->listen_fd);
+    }
+    if (srv->bound)
+    {
+        unlink(srv->socket_path);
+    }
+    if (srv->epoll_fd >= 0)
+    {
+        close(srv->epoll_fd);
+    }
+    if (srv->event_fd >= 0)
+    {
+        close(srv->event_fd);
+    }
+
+    tree_snapshot_slot_free(srv->slot);
+    tree_cond_destroy(&srv->job_cond);
+    tree_cond_destroy(&srv->reload_cond);
+    tree_mutex_destroy(&srv->lock);
+    tree_mem_free(srv->socket_path);
+    tree_mem_free(srv->filename);
+    tree_mem_free(srv);
+}
+
+/* ---------------- ѹͻ ---------------- */
+
+typedef struct BenchWorker
+{
+    const char* socket_path;
+    size_t requests;
+    int pipeline;
+    uint32_t seed;
+    uint64_t* latency; /* ÿʱ䣨룩±Ϊ */
+    uint64_t errors;
+    int failed;
+    tree_thread_t thread;
+} BenchWorker;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t bench_rand(uint32_t* state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static int write_all(int fd, const char* p, size_t n)
+{
+    while (n > 0)
+    {
+        ssize_t w = send(fd, p, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (w <= 0)
+        {
+            return -1;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static int bench_connect(const char* path)
+{
+    struct sockaddr_un addr;
+    size_t len = strlen(path);
+    if (len >= sizeof(addr.sun_path))
+    {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path, len + 1);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*  fd 룬ֱ rb һ֡ظ֡ܳȣʧܷ 0 */
+static size_t bench_read_frame(int fd, Buf* rb)
+{
+    for (;;)
+    {
+        if (rb->len >= 4)
+        {
+            size_t need = 4 + (size_t)get_u32(rb->data);
+            if (rb->len >= need)
+            {
+                return need;
+            }
+        }
+        if (buf_reserve(rb, CONN_READ_CHUNK) != 0)
+        {
+            return 0;
+        }
+        ssize_t n = read(fd, rb->data + rb->len, rb->cap - rb->len);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return 0;
+        }
+        rb->len += (size_t)n;
+    }
+}
+
+/*  wb ĩβдһ֡ */
+static void bench_put_request(Buf* wb, uint32_t id, TreeQueryOp op, const char* arg, size_t arglen)
+{
+    char* p = wb->data + wb->len;
+    put_u32(p, (uint32_t)(5 + arglen));
+    put_u32(p + 4, id);
+    p[8] = (char)op;
+    if (arglen > 0)
+    {
+        memcpy(p + 9, arg, arglen);
+    }
+    wb->len += 9 + arglen;
+}
+
+static TREE_THREAD_PROC(bench_main, arg)
+{
+    BenchWorker* w = (BenchWorker*)arg;
+    Buf rb = { NULL, 0, 0 };
+    Buf wb = { NULL, 0, 0 };
+    uint64_t* sent_at = (uint64_t*)tree_mem_alloc(sizeof(uint64_t) * w->requests);
+    unsigned char* ops = (unsigned char*)tree_mem_alloc(w->requests);
+    char label[256];
+    size_t label_len = 0;
+    int have_label = 0;
+
+    int fd = bench_connect(w->socket_path);
+    w->failed = 1;
+    if (fd < 0 || !sent_at || !ops || buf_reserve(&wb, (size_t)w->pipeline * (9 + sizeof(label))) != 0)
+    {
+        goto done;
+    }
+
+    /* ȡڵ֮Ĳѯ [0, count) ȡڵ */
+    bench_put_request(&wb, TREE_NO_NODE, TREE_OP_STATS, NULL, 0);
+    if (write_all(fd, wb.data, wb.len) != 0)
+    {
+        goto done;
+    }
+    wb.len = 0;
+    size_t flen = bench_read_frame(fd, &rb);
+    if (flen < 9 + 8 || rb.data[8] != TREE_QUERY_OK)
+    {
+        goto done;
+    }
+    uint64_t count = get_u64(rb.data + 9);
+    rb.len -= flen;
+    memmove(rb.data, rb.data + flen, rb.len);
+    if (count == 0)
+    {
+        goto done;
+    }
+
+    size_t sent = 0;
+    size_t received = 0;
+    while (received < w->requests)
+    {
+        /* ;ڣϲΪһд */
+        wb.len = 0;
+        while (sent < w->requests && sent - received < (size_t)w->pipeline)
+        {
+            char args[8];
+            uint32_t a = (uint32_t)(bench_rand(&w->seed) % count);
+            uint32_t b = (uint32_t)(bench_rand(&w->seed) % count);
+            put_u32(args, a);
+            put_u32(args + 4, b);
+
+            TreeQueryOp op;
+            switch (sent % 8)
+            {
+            case 0: case 5: op = TREE_OP_LEVEL; break;
+            case 2: case 6: op = TREE_OP_ANCESTOR; break;
+            case 3: op = have_label ? TREE_OP_FIND : TREE_OP_SUBTREE; break;
+            case 7: op = TREE_OP_STATS; break;
+            default: op = TREE_OP_SUBTREE; break;
+            }
+
+            ops[sent] = (unsigned char)op;
+            sent_at[sent] = now_ns();
+            if (op == TREE_OP_FIND)
+            {
+                bench_put_request(&wb, (uint32_t)sent, op, label, label_len);
+            }
+            else if (op == TREE_OP_ANCESTOR)
+            {
+                bench_put_request(&wb, (uint32_t)sent, op, args, 8);
+            }
+            else if (op == TREE_OP_STATS)
+            {
+                bench_put_request(&wb, (uint32_t)sent, op, NULL, 0);
+            }
+            else
+            {
+                bench_put_request(&wb, (uint32_t)sent, op, args, 4);
+            }
+            sent++;
+        }
+        if (wb.len > 0 && write_all(fd, wb.data, wb.len) != 0)
+        {
+            goto done;
+        }
+
+        /* һӦٴӦ */
+        if (bench_read_frame(fd, &rb) == 0)
+        {
+            goto done;
+        }
+        uint64_t now = now_ns();
+        size_t off = 0;
+        while (rb.len - off >= 4)
+        {
+            size_t len = get_u32(rb.data + off);
+            if (len < 5 || rb.len - off - 4 < len)
+            {
+                break;
+            }
+            const char* p = rb.data + off + 4;
+            uint32_t id = get_u32(p);
+            if (id >= sent)
+            {
+                goto done;
+            }
+            w->latency[id] = now - sent_at[id];
+            if (p[4] != TREE_QUERY_OK)
+            {
+                w->errors++;
+            }
+            else if (ops[id] == TREE_OP_SUBTREE && len > 5 + 16)
+            {
+                /* һʵڵıǩ FIND ʹ */
+                label_len = len - 5 - 16;
+                if (label_len > sizeof(label))
+                {
+                    label_len = sizeof(label);
+                }
+                memcpy(label, p + 5 + 16, label_len);
+                have_label = 1;
+            }
+            received++;
+            off += 4 + len;
+        }
+        rb.len -= off;
+        memmove(rb.data, rb.data + off, rb.len);
+    }
+    w->failed = 0;
+
+done:
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+    tree_mem_free(rb.data);
+    tree_mem_free(wb.data);
+    tree_mem_free(sent_at);
+    tree_mem_free(ops);
+    TREE_THREAD_RETURN;
+}
+
+static int compare_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+int tree_server_bench(const char* socket_path, int threads, size_t requests, int pipeline, TreeBenchResult* out)
+{
+    if (!socket_path || !out || requests == 0 || requests >= TREE_NO_NODE)
+    {
+        return -1;
+    }
+    if (threads <= 0)
+    {
+        threads = 1;
+    }
+    if (pipeline <= 0)
+    {
+        pipeline = 1;
+    }
+    memset(out, 0, sizeof(*out));
+
+    size_t total = (size_t)threads * requests;
+    BenchWorker* workers = (BenchWorker*)tree_mem_calloc((size_t)threads, sizeof(BenchWorker));
+    uint64_t* latency = (uint64_t*)tree_mem_calloc(total, sizeof(uint64_t));
+    if (!workers || !latency)
+    {
+        tree_mem_free(workers);
+        tree_mem_free(latency);
+        return -1;
+    }
+
+    uint64_t start = now_ns();
+    int started = 0;
+    for (int i = 0; i < threads; ++i)
+    {
+        BenchWorker* w = &workers[i];
+        w->socket_path = socket_path;
+        w->requests = requests;
+        w->pipeline = pipeline;
+        w->seed = 2463534242u + (uint32_t)i * 7919u;
+        w->latency = latency + (size_t)i * requests;
+        if (tree_thread_start(&w->thread, bench_main, w) != 0)
+        {
+            w->failed = 1;
+            break;
+        }
+        started++;
+    }
+
+    int failed = (started < threads);
+    for (int i = 0; i < started; ++i)
+    {
+        tree_thread_join(workers[i].thread);
+        failed |= workers[i].failed;
+        out->errors += workers[i].errors;
+    }
+    uint64_t elapsed = now_ns() - start;
+
+    if (!failed)
+    {
+        qsort(latency, total, sizeof(uint64_t), compare_u64);
+        out->requests = total;
+        out->seconds = (double)elapsed / 1e9;
+        out->qps = (out->seconds > 0.0) ? (double)total / out->seconds : 0.0;
+        out->p50_us = (double)latency[(size_t)(0.50 * (double)(total - 1))] / 1e3;
+        out->p99_us = (double)latency[(size_t)(0.99 * (double)(total - 1))] / 1e3;
+        out->max_us = (double)latency[total - 1] / 1e3;
+    }
+
+    tree_mem_free(workers);
+    tree_mem_free(latency);
+    return failed ? -1 : 0;
+}
+
+#else /* !__linux__ */
+
+/* epolleventfd  signalfd ֻ Linux Ͽãƽ̨Ϸģʽ */
+
+TreeServer* tree_server_create(const char* socket_path, const char* filename, int workers)
+{
+    (void)socket_path;
+    (void)filename;
+    (void)workers;
+    return NULL;
+}
+
+int tree_server_run(TreeServer* server)
+{
+    (void)server;
+    return -1;
+}
+
+void tree_server_stop(TreeServer* server)
+{
+    (void)server;
+}
+
+void tree_server_free(TreeServer* server)
+{
+    (void)server;
+}
+
+int tree_server_bench(const char* socket_path, int threads, size_t requests, int pipeline, TreeBenchResult* out)
+{
+    (void)socket_path;
+    (void)threads;
+    (void)requests;
+    (void)pipeline;
+    if (out)
+    {
+        memset(out, 0, sizeof(*out));
+    }
+    return -1;
+}
+
+#endif /* __linux__ */
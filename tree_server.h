@@ -0,0 +1,75 @@
+#pragma once
+#ifndef TREE_SERVER_H
+#define TREE_SERVER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * زѯ񣨽 LinuxֻһΣͨ Unix ׽ֲѯ
+ * epoll ¼ѭշ̳߳ظ㣻ͬһӿͶ
+ * ȴӦˮߣһζĶ֡Ϊһͬһ̣߳
+ * Ӧ˳򷵻ء
+ *
+ * Э飨ֻֽڱ
+ *   ֡uint32  | uint32  | uint8  | 
+ *   Ӧ֡uint32  | uint32  | uint8 ״̬ | 
+ * Ȳ 4 ֽڡڵɭֵűʾһĸΪ 0
+ */
+
+typedef enum TreeQueryOp
+{
+    TREE_OP_STATS = 1,    /* ޲ -> u64 ڵ, u64 Ҷ, u32 , u32 , u32  */
+    TREE_OP_FIND = 2,     /* ǩֽ -> u32 ƥ, u32 ظ, u32 [ظ] TREE_FIND_MAX_IDS  */
+    TREE_OP_LEVEL = 3,    /* u32 ڵ -> u32 ΣΪ 1 */
+    TREE_OP_ANCESTOR = 4, /* u32 a, u32 b -> u8 a ǷΪ b ȣ, u32 ȣͬһʱΪ TREE_NO_NODE */
+    TREE_OP_SUBTREE = 5,  /* u32 ڵ -> u32 С, u32 ߶, u32 , u32 ڵ, ǩֽ */
+    TREE_OP_RELOAD = 6    /* ޲ -> u64 ڵԭļ¼أڽеĲѯʹþ
+                           * ڵ߳νУͬʱȴĶ RELOAD һμ */
+} TreeQueryOp;
+
+typedef enum TreeQueryStatus
+{
+    TREE_QUERY_OK = 0,
+    TREE_QUERY_BAD_REQUEST = 1, /* δ֪Ȳ */
+    TREE_QUERY_NOT_FOUND = 2,   /* ڵԽ */
+    TREE_QUERY_FAILED = 3       /* ¼ʧܵ */
+} TreeQueryStatus;
+
+#define TREE_NO_NODE 0xFFFFFFFFu
+#define TREE_FIND_MAX_IDS 64
+#define TREE_FRAME_MAX 65536u /* ֡ޣϿ */
+
+typedef struct TreeServer TreeServer;
+
+/*  filenamebuildTreeFromFile ʽ socket_pathworkers <= 0 ʱʹ 4 ߳ */
+TreeServer* tree_server_create(const char* socket_path, const char* filename, int workers);
+
+/* ¼ѭֱ tree_server_stop յ SIGINT/SIGTERMɹ 0 */
+int tree_server_run(TreeServer* server);
+
+/* ̵߳ã tree_server_run  */
+void tree_server_stop(TreeServer* server);
+
+/* رӡɾ׽ļͷ */
+void tree_server_free(TreeServer* server);
+
+/* ѹӳٵλΪ΢ */
+typedef struct TreeBenchResult
+{
+    uint64_t requests;
+    uint64_t errors;
+    double seconds;
+    double qps;
+    double p50_us;
+    double p99_us;
+    double max_us;
+} TreeBenchResult;
+
+/*
+ * ѹͻˣthreads Ӹ requests ϲѯ
+ * ÿӱ pipeline ;ϲΪһд롣ɹ 0
+ */
+int tree_server_bench(const char* socket_path, int threads, size_t requests, int pipeline, TreeBenchResult* out);
+
+#endif /* TREE_SERVER_H */
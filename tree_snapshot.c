@@ -0,0 +1,157 @@
+#ifndef _WIN32
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdlib.h>
+#include "tree_snapshot.h"
+#include "tree_thread.h"
+
+struct TreeSnapshot
+{
+    TreeNode* root;
+    TreeSnapshotDestroyFn destroy;
+    void* ctx;
+    tree_atomic_t refs;
+};
+
+/*
+ * 㡣ߵٽֻС current üһСΣ
+ * ǰ pins[epoch & 1] ϵǼǡ뿪ע
+ * д߽ current ηת epochÿεȴżĵǼ㣺
+ * κοָܶĶ߶ڽ֮ǰǼǣһκ
+ * Щ߱ȻѾɶԾɿյüһʱͷŷǰȫġ
+ * תĶߵǼǵһϣд߲ᱻĶ߶
+ */
+struct TreeSnapshotSlot
+{
+    tree_atomic_ptr_t current;
+    tree_atomic_t epoch;
+    tree_atomic_t pins[2];
+    tree_mutex_t writer_lock;
+};
+
+TreeSnapshot* tree_snapshot_create(TreeNode* root, TreeSnapshotDestroyFn destroy, void* ctx)
+{
+    TreeSnapshot* snap = (TreeSnapshot*)tree_mem_alloc(sizeof(TreeSnapshot));
+    if (!snap)
+    {
+        return NULL;
+    }
+
+    snap->root = root;
+    snap->destroy = destroy;
+    snap->ctx = ctx;
+    tree_atomic_store(&snap->refs, 1);
+    return snap;
+}
+
+const TreeNode* tree_snapshot_root(const TreeSnapshot* snap)
+{
+    return snap ? snap->root : NULL;
+}
+
+void* tree_snapshot_context(const TreeSnapshot* snap)
+{
+    return snap ? snap->ctx : NULL;
+}
+
+void tree_snapshot_retain(TreeSnapshot* snap)
+{
+    if (snap)
+    {
+        tree_atomic_add(&snap->refs, 1);
+    }
+}
+
+void tree_snapshot_release(TreeSnapshot* snap)
+{
+    if (!snap || tree_atomic_add(&snap->refs, -1) != 0)
+    {
+        return;
+    }
+
+    if (snap->destroy)
+    {
+        snap->destroy(snap->root, snap->ctx);
+    }
+    else
+    {
+        tree_free(snap->root);
+    }
+    tree_mem_free(snap);
+}
+
+TreeSnapshotSlot* tree_snapshot_slot_create(void)
+{
+    TreeSnapshotSlot* slot = (TreeSnapshotSlot*)tree_mem_alloc(sizeof(TreeSnapshotSlot));
+    if (!slot)
+    {
+        return NULL;
+    }
+
+    slot->current = NULL;
+    tree_atomic_store(&slot->epoch, 0);
+    tree_atomic_store(&slot->pins[0], 0);
+    tree_atomic_store(&slot->pins[1], 0);
+    tree_mutex_init(&slot->writer_lock);
+    return slot;
+}
+
+void tree_snapshot_slot_free(TreeSnapshotSlot* slot)
+{
+    if (!slot)
+    {
+        return;
+    }
+
+    tree_snapshot_release((TreeSnapshot*)tree_atomic_ptr_load(&slot->current));
+    tree_mutex_destroy(&slot->writer_lock);
+    tree_mem_free(slot);
+}
+
+TreeSnapshot* tree_snapshot_acquire(TreeSnapshotSlot* slot)
+{
+    if (!slot)
+    {
+        return NULL;
+    }
+
+    long long e = tree_atomic_load(&slot->epoch) & 1;
+    tree_atomic_add(&slot->pins[e], 1);
+
+    TreeSnapshot* snap = (TreeSnapshot*)tree_atomic_ptr_load(&slot->current);
+    if (snap)
+    {
+        tree_atomic_add(&snap->refs, 1);
+    }
+
+    tree_atomic_add(&slot->pins[e], -1);
+    return snap;
+}
+
+void tree_snapshot_publish(TreeSnapshotSlot* slot, TreeSnapshot* snap)
+{
+    if (!slot)
+    {
+        tree_snapshot_release(snap);
+        return;
+    }
+
+    tree_mutex_lock(&slot->writer_lock);
+
+    TreeSnapshot* old = (TreeSnapshot*)tree_atomic_ptr_exchange(&slot->current, snap);
+
+    for (int round = 0; round < 2; ++round)
+    {
+        long long e = tree_atomic_load(&slot->epoch);
+        tree_atomic_store(&slot->epoch, e + 1);
+        while (tree_atomic_load(&slot->pins[e & 1]) != 0)
+        {
+            tree_thread_yield();
+        }
+    }
+
+    tree_mutex_unlock(&slot->writer_lock);
+
+    /* ԾɿյãʹĶ߸Գ */
+    tree_snapshot_release(old);
+}
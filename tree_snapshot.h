@@ -0,0 +1,52 @@
+#pragma once
+#ifndef TREE_SNAPSHOT_H
+#define TREE_SNAPSHOT_H
+
+#include "tree.h"
+
+/*
+ * ɱգԭü
+ * մеٱ޸ģ߳̿ͬʱֻʣ
+ * һͷʱŵ destroy 
+ */
+typedef struct TreeSnapshot TreeSnapshot;
+
+/* պͷԼһ𱣴 ctx */
+typedef void (*TreeSnapshotDestroyFn)(TreeNode* root, void* ctx);
+
+/*
+ * ղӹ root ȨʼüΪ 1
+ * destroy Ϊ NULL ʱ tree_freeǵݹ飬ȫͷ rootctx Ӧֻݣ
+ */
+TreeSnapshot* tree_snapshot_create(TreeNode* root, TreeSnapshotDestroyFn destroy, void* ctx);
+
+const TreeNode* tree_snapshot_root(const TreeSnapshot* snap);
+void* tree_snapshot_context(const TreeSnapshot* snap);
+
+/*  / ͷһ */
+void tree_snapshot_retain(TreeSnapshot* snap);
+void tree_snapshot_release(TreeSnapshot* snap);
+
+/*
+ * 㣺桰ǰա
+ *  tree_snapshot_acquire ȡõǰյã
+ * дڱ𴦹 tree_snapshot_publish ԭ滻
+ * ɿһͷźűգRCU 񣩡
+ */
+typedef struct TreeSnapshotSlot TreeSnapshotSlot;
+
+TreeSnapshotSlot* tree_snapshot_slot_create(void);
+
+/* ٷ㲢ͷеĵǰգʱж߻дʹø÷ */
+void tree_snapshot_slot_free(TreeSnapshotSlot* slot);
+
+/* ȡõǰգü +1 tree_snapshot_releaseδʱ NULL */
+TreeSnapshot* tree_snapshot_acquire(TreeSnapshotSlot* slot);
+
+/*
+ * ¿գӹܵ߶ snap ãsnap Ϊ NULL ʾգ
+ * ȴȡյĶ뿪ٽͷŷԾɿյãд֮以⡣
+ */
+void tree_snapshot_publish(TreeSnapshotSlot* slot, TreeSnapshot* snap);
+
+#endif /* TREE_SNAPSHOT_H */
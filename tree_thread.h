@@ -0,0 +1,233 @@
+#pragma once
+#ifndef TREE_THREAD_H
+#define TREE_THREAD_H
+
+/*
+ * ߳ԭӲСװڲʹã
+ * Windows ʹ Win32 ̡߳SRW  Interlocked ϵк
+ * ƽ̨ʹ pthread  GCC/Clang  __atomic ڽ
+ * ʹñͷļ .c ļڰκϵͳͷļ֮ǰ _POSIX_C_SOURCE Windows
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+/* ---------------- ߳ ---------------- */
+
+#ifdef _WIN32
+typedef HANDLE tree_thread_t;
+#define TREE_THREAD_PROC(name, arg) DWORD WINAPI name(LPVOID arg)
+#define TREE_THREAD_RETURN return 0
+typedef LPTHREAD_START_ROUTINE tree_thread_proc;
+#else
+typedef pthread_t tree_thread_t;
+#define TREE_THREAD_PROC(name, arg) void* name(void* arg)
+#define TREE_THREAD_RETURN return NULL
+typedef void* (*tree_thread_proc)(void*);
+#endif
+
+/* ɹ 0 */
+static inline int tree_thread_start(tree_thread_t* t, tree_thread_proc proc, void* arg)
+{
+#ifdef _WIN32
+    *t = CreateThread(NULL, 0, proc, arg, 0, NULL);
+    return (*t != NULL) ? 0 : -1;
+#else
+    return (pthread_create(t, NULL, proc, arg) == 0) ? 0 : -1;
+#endif
+}
+
+static inline void tree_thread_join(tree_thread_t t)
+{
+#ifdef _WIN32
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+static inline void tree_thread_yield(void)
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+/* ----------------  ---------------- */
+
+#ifdef _WIN32
+typedef SRWLOCK tree_mutex_t;
+typedef CONDITION_VARIABLE tree_cond_t;
+#else
+typedef pthread_mutex_t tree_mutex_t;
+typedef pthread_cond_t tree_cond_t;
+#endif
+
+static inline void tree_mutex_init(tree_mutex_t* m)
+{
+#ifdef _WIN32
+    InitializeSRWLock(m);
+#else
+    pthread_mutex_init(m, NULL);
+#endif
+}
+
+static inline void tree_mutex_destroy(tree_mutex_t* m)
+{
+#ifdef _WIN32
+    (void)m;
+#else
+    pthread_mutex_destroy(m);
+#endif
+}
+
+static inline void tree_mutex_lock(tree_mutex_t* m)
+{
+#ifdef _WIN32
+    AcquireSRWLockExclusive(m);
+#else
+    pthread_mutex_lock(m);
+#endif
+}
+
+static inline void tree_mutex_unlock(tree_mutex_t* m)
+{
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(m);
+#else
+    pthread_mutex_unlock(m);
+#endif
+}
+
+static inline void tree_cond_init(tree_cond_t* c)
+{
+#ifdef _WIN32
+    InitializeConditionVariable(c);
+#else
+    pthread_cond_init(c, NULL);
+#endif
+}
+
+static inline void tree_cond_destroy(tree_cond_t* c)
+{
+#ifdef _WIN32
+    (void)c;
+#else
+    pthread_cond_destroy(c);
+#endif
+}
+
+static inline void tree_cond_wait(tree_cond_t* c, tree_mutex_t* m)
+{
+#ifdef _WIN32
+    SleepConditionVariableSRW(c, m, INFINITE, 0);
+#else
+    pthread_cond_wait(c, m);
+#endif
+}
+
+/* ȴ timeout_ms 룻ʱ 0ѷ 1Ϊٻѣ */
+static inline int tree_cond_timedwait(tree_cond_t* c, tree_mutex_t* m, unsigned long timeout_ms)
+{
+#ifdef _WIN32
+    return SleepConditionVariableSRW(c, m, (DWORD)timeout_ms, 0) ? 1 : 0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += (time_t)(timeout_ms / 1000);
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    return (pthread_cond_timedwait(c, m, &ts) == ETIMEDOUT) ? 0 : 1;
+#endif
+}
+
+static inline void tree_cond_broadcast(tree_cond_t* c)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(c);
+#else
+    pthread_cond_broadcast(c);
+#endif
+}
+
+static inline void tree_cond_signal(tree_cond_t* c)
+{
+#ifdef _WIN32
+    WakeConditionVariable(c);
+#else
+    pthread_cond_signal(c);
+#endif
+}
+
+/* ---------------- ԭӲ˳һ£ ---------------- */
+
+#ifdef _MSC_VER
+typedef volatile LONG64 tree_atomic_t;
+#else
+typedef volatile long long tree_atomic_t;
+#endif
+
+static inline long long tree_atomic_load(tree_atomic_t* p)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchange64(p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+static inline void tree_atomic_store(tree_atomic_t* p, long long v)
+{
+#ifdef _MSC_VER
+    InterlockedExchange64(p, v);
+#else
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* ֵ֮ */
+static inline long long tree_atomic_add(tree_atomic_t* p, long long v)
+{
+#ifdef _MSC_VER
+    return InterlockedExchangeAdd64(p, v) + v;
+#else
+    return __atomic_add_fetch(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* ָԭӶȡ뽻 */
+typedef void* volatile tree_atomic_ptr_t;
+
+static inline void* tree_atomic_ptr_load(tree_atomic_ptr_t* p)
+{
+#ifdef _MSC_VER
+    return InterlockedCompareExchangePointer(p, NULL, NULL);
+#else
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* ؽǰֵ */
+static inline void* tree_atomic_ptr_exchange(tree_atomic_ptr_t* p, void* v)
+{
+#ifdef _MSC_VER
+    return InterlockedExchangePointer(p, v);
+#else
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif /* TREE_THREAD_H */
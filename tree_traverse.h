@@ -0,0 +1,259 @@
+#pragma once
+#ifndef TREE_TRAVERSE_H
+#define TREE_TRAVERSE_H
+
+#include <string.h>
+#include "tree.h"
+
+/*
+ * ػıÿʹôչΪһ
+ *
+ *     static int name(const TreeNode* root, ctx_type ctx);
+ *
+ * 壨һԺţֱڷǵݹѭ
+ * ûڵĺָã԰ѭһŻпʹã
+ *     node   const TreeNode*ǰڵ
+ *     depth  size_tǰڵȣroot ڲΪ 1
+ *     ctx    ʱģָͨۼָ룩
+ * ˳ֱ tree_preorder / tree_postorder / tree_level_order ͬ root ֵܡ
+ * вҪʹ returnbreak  continueҲҪ޸Ľṹ
+ * ջ/ջ飬ʱ tree_mem_* չɹ 0ڴ治㷵 -1ѷʵĽڵ㲻ظʣ
+ *
+ * 
+ *     TREE_DEFINE_PREORDER(count_leaves, size_t*, if (!node->first_child) { ++*ctx; })
+ */
+
+#define TREE_TRAVERSE_LOCAL 64
+
+/*  used ԪصĻһbuf Ϊջ local ʱΪڶϷ䡣ʧܷ NULLԭ岻 */
+static inline void* tree_traverse_grow(void* buf, const void* local, size_t* cap, size_t elem, size_t used)
+{
+    size_t newcap = *cap * 2;
+    void* nb;
+    if (buf == local)
+    {
+        nb = tree_mem_alloc(elem * newcap);
+        if (nb)
+        {
+            memcpy(nb, local, elem * used);
+        }
+    }
+    else
+    {
+        nb = tree_mem_realloc(buf, elem * newcap);
+    }
+    if (nb)
+    {
+        *cap = newcap;
+    }
+    return nb;
+}
+
+/* ȸõջԪأδʵֵܼ */
+typedef struct TreeTraverseFrame
+{
+    const TreeNode* node;
+    size_t depth;
+} TreeTraverseFrame;
+
+/* ȸ first_child һ·£ֻлʣֵʱջûкҲûֵʱջ */
+#define TREE_DEFINE_PREORDER(name, ctx_type, ...)                                       \
+static int name(const TreeNode* root, ctx_type ctx)                                     \
+{                                                                                       \
+    TreeTraverseFrame tt_local[TREE_TRAVERSE_LOCAL];                                    \
+    TreeTraverseFrame* tt_stack = tt_local;                                             \
+    size_t tt_cap = TREE_TRAVERSE_LOCAL;                                                \
+    size_t tt_sp = 0;                                                                   \
+    const TreeNode* tt_node = root;                                                     \
+    size_t tt_depth = 1;                                                                \
+    int tt_rc = 0;                                                                      \
+    (void)ctx;                                                                          \
+    while (tt_node)                                                                     \
+    {                                                                                   \
+        {                                                                               \
+            const TreeNode* node = tt_node;                                             \
+            size_t depth = tt_depth;                                                    \
+            (void)depth;                                                                \
+            { __VA_ARGS__ }                                                             \
+        }                                                                               \
+        if (tt_node->first_child)                                                       \
+        {                                                                               \
+            if (tt_node->next_sibling)                                                  \
+            {                                                                           \
+                if (tt_sp >= tt_cap)                                                    \
+                {                                                                       \
+                    TreeTraverseFrame* tt_ns = (TreeTraverseFrame*)tree_traverse_grow(  \
+                        tt_stack, tt_local, &tt_cap, sizeof(*tt_stack), tt_sp);         \
+                    if (!tt_ns)                                                         \
+                    {                                                                   \
+                        tt_rc = -1;                                                     \
+                        break;                                                          \
+                    }                                                                   \
+                    tt_stack = tt_ns;                                                   \
+                }                                                                       \
+                tt_stack[tt_sp].node = tt_node->next_sibling;                           \
+                tt_stack[tt_sp].depth = tt_depth;                                       \
+                tt_sp++;                                                                \
+            }                                                                           \
+            tt_node = tt_node->first_child;                                             \
+            tt_depth++;                                                                 \
+        }                                                                               \
+        else if (tt_node->next_sibling)                                                 \
+        {                                                                               \
+            tt_node = tt_node->next_sibling;                                            \
+        }                                                                               \
+        else if (tt_sp > 0)                                                             \
+        {                                                                               \
+            tt_sp--;                                                                    \
+            tt_node = tt_stack[tt_sp].node;                                             \
+            tt_depth = tt_stack[tt_sp].depth;                                           \
+        }                                                                               \
+        else                                                                            \
+        {                                                                               \
+            tt_node = NULL;                                                             \
+        }                                                                               \
+    }                                                                                   \
+    if (tt_stack != tt_local)                                                           \
+    {                                                                                   \
+        tree_mem_free(tt_stack);                                                        \
+    }                                                                                   \
+    return tt_rc;                                                                       \
+}
+
+/*
+ *  first_child ½ʱѹջҶӺûֵܾջȡ
+ * ջǡǵǰڵȫȣΪջ + 1չгΡ
+ */
+#define TREE_DEFINE_POSTORDER(name, ctx_type, ...)                                      \
+static int name(const TreeNode* root, ctx_type ctx)                                     \
+{                                                                                       \
+    const TreeNode* tt_local[TREE_TRAVERSE_LOCAL];                                      \
+    const TreeNode** tt_stack = tt_local;                                               \
+    size_t tt_cap = TREE_TRAVERSE_LOCAL;                                                \
+    size_t tt_sp = 0;                                                                   \
+    const TreeNode* tt_node = root;                                                     \
+    int tt_rc = 0;                                                                      \
+    (void)ctx;                                                                          \
+    while (tt_node)                                                                     \
+    {                                                                                   \
+        while (tt_node->first_child)                                                    \
+        {                                                                               \
+            if (tt_sp >= tt_cap)                                                        \
+            {                                                                           \
+                const TreeNode** tt_ns = (const TreeNode**)tree_traverse_grow(          \
+                    (void*)tt_stack, tt_local, &tt_cap, sizeof(*tt_stack), tt_sp);      \
+                if (!tt_ns)                                                             \
+                {                                                                       \
+                    tt_rc = -1;                                                         \
+                    break;                                                              \
+                }                                                                       \
+                tt_stack = tt_ns;                                                       \
+            }                                                                           \
+            tt_stack[tt_sp++] = tt_node;                                                \
+            tt_node = tt_node->first_child;                                             \
+        }                                                                               \
+        if (tt_rc != 0)                                                                 \
+        {                                                                               \
+            break;                                                                      \
+        }                                                                               \
+        {                                                                               \
+            const TreeNode* node = tt_node;                                             \
+            size_t depth = tt_sp + 1;                                                   \
+            (void)depth;                                                                \
+            { __VA_ARGS__ }                                                             \
+        }                                                                               \
+        while (!tt_node->next_sibling && tt_sp > 0)                                     \
+        {                                                                               \
+            tt_node = tt_stack[--tt_sp];                                                \
+            {                                                                           \
+                const TreeNode* node = tt_node;                                         \
+                size_t depth = tt_sp + 1;                                               \
+                (void)depth;                                                            \
+                { __VA_ARGS__ }                                                         \
+            }                                                                           \
+        }                                                                               \
+        tt_node = tt_node->next_sibling;                                                \
+    }                                                                                   \
+    if (tt_stack != tt_local)                                                           \
+    {                                                                                   \
+        tree_mem_free((void*)tt_stack);                                                 \
+    }                                                                                   \
+    return tt_rc;                                                                       \
+}
+
+/* αĶԪأһֵ */
+typedef struct TreeTraverseChain
+{
+    const TreeNode* head;
+    size_t depth;
+} TreeTraverseChain;
+
+/*
+ * Σζдֵͷǵڵ㣬
+ * ӺʣÿڵĺӣгֻҶڵйء
+ */
+#define TREE_DEFINE_LEVEL_ORDER(name, ctx_type, ...)                                    \
+static int name(const TreeNode* root, ctx_type ctx)                                     \
+{                                                                                       \
+    TreeTraverseChain tt_local[TREE_TRAVERSE_LOCAL];                                    \
+    TreeTraverseChain* tt_queue = tt_local;                                             \
+    size_t tt_cap = TREE_TRAVERSE_LOCAL;                                                \
+    size_t tt_head = 0;                                                                 \
+    size_t tt_count = 0;                                                                \
+    int tt_rc = 0;                                                                      \
+    (void)ctx;                                                                          \
+    if (root)                                                                           \
+    {                                                                                   \
+        tt_queue[0].head = root;                                                        \
+        tt_queue[0].depth = 1;                                                          \
+        tt_count = 1;                                                                   \
+    }                                                                                   \
+    while (tt_count > 0 && tt_rc == 0)                                                  \
+    {                                                                                   \
+        TreeTraverseChain tt_chain = tt_queue[tt_head];                                 \
+        tt_head = (tt_head + 1) & (tt_cap - 1);                                         \
+        tt_count--;                                                                     \
+        for (const TreeNode* node = tt_chain.head; node; node = node->next_sibling)     \
+        {                                                                               \
+            size_t depth = tt_chain.depth;                                              \
+            (void)depth;                                                                \
+            { __VA_ARGS__ }                                                             \
+            if (!node->first_child)                                                     \
+            {                                                                           \
+                continue;                                                               \
+            }                                                                           \
+            if (tt_count == tt_cap)                                                     \
+            {                                                                           \
+                /* ʱ˳չ»壬Ϊ 2  */                   \
+                TreeTraverseChain* tt_nq = (TreeTraverseChain*)tree_mem_alloc(          \
+                    sizeof(TreeTraverseChain) * tt_cap * 2);                            \
+                if (!tt_nq)                                                             \
+                {                                                                       \
+                    tt_rc = -1;                                                         \
+                    break;                                                              \
+                }                                                                       \
+                size_t tt_first = tt_cap - tt_head;                                     \
+                memcpy(tt_nq, tt_queue + tt_head, sizeof(TreeTraverseChain) * tt_first);\
+                memcpy(tt_nq + tt_first, tt_queue, sizeof(TreeTraverseChain) * tt_head);\
+                if (tt_queue != tt_local)                                               \
+                {                                                                       \
+                    tree_mem_free(tt_queue);                                            \
+                }                                                                       \
+                tt_queue = tt_nq;                                                       \
+                tt_head = 0;                                                            \
+                tt_cap *= 2;                                                            \
+            }                                                                           \
+            size_t tt_tail = (tt_head + tt_count) & (tt_cap - 1);                       \
+            tt_queue[tt_tail].head = node->first_child;                                 \
+            tt_queue[tt_tail].depth = tt_chain.depth + 1;                               \
+            tt_count++;                                                                 \
+        }                                                                               \
+    }                                                                                   \
+    if (tt_queue != tt_local)                                                           \
+    {                                                                                   \
+        tree_mem_free(tt_queue);                                                        \
+    }                                                                                   \
+    return tt_rc;                                                                       \
+}
+
+#endif /* TREE_TRAVERSE_H */